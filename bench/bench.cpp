@@ -0,0 +1,366 @@
+/*
+* Microbenchmarks for the hot paths of the game
+*   - Physics and collision benchmarks only need pong_core
+*   - With the frontend enabled, PlayerScore::setScore and a whole PLAYING frame are
+*     also measured, using SDL's dummy video driver and the software renderer so no
+*     display or GPU is needed (run from the repository root so the font is found)
+*   - Results are printed as JSON, to compare runs over time
+*
+* Usage: pong_bench [--filter=TEXT] [--min-time=SECONDS] [--out=PATH]
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "core/ai.h"
+#include "core/arena.h"
+#include "core/batch.h"
+#include "core/collision.h"
+#include "core/game.h"
+#include "net/spectator.h"
+
+#ifdef PONG_BENCH_SDL
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "assets.h"
+#include "draw_list.h"
+#include "player_score.h"
+#include "text_atlas.h"
+#include "video_recorder.h"
+#endif
+
+using namespace pong;
+
+// Keeps the compiler from optimizing away a value the benchmark computes
+template <class T>
+inline void DoNotOptimize(T const& value){
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult{
+    std::string name;
+    unsigned long long iterations;
+    double nsPerOp;
+    
+    // How many items one iteration processes, e.g. matches for the batch benchmarks
+    double itemsPerOp;
+};
+
+struct BenchOptions{
+    const char* filter = nullptr;
+    double minTime = 0.2;
+    const char* outPath = nullptr;
+};
+
+static std::vector<BenchResult> results;
+static BenchOptions benchOptions;
+
+/*
+* Runs `body` in a loop until it takes at least minTime, doubling the iteration count,
+* three times over, and keeps the fastest time per iteration
+*/
+template <class F>
+static void Bench(const char* name, double itemsPerOp, F&& body){
+    if(benchOptions.filter && !std::strstr(name, benchOptions.filter)){
+        return;
+    }
+    
+    double best = 0.0;
+    unsigned long long bestIterations = 0;
+    for(int repetition = 0; repetition < 3; ++repetition){
+        for(unsigned long long iterations = 1; ; iterations *= 2){
+            auto start = std::chrono::steady_clock::now();
+            for(unsigned long long i = 0; i < iterations; ++i){
+                body();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if(seconds >= benchOptions.minTime || iterations >= (1ull << 40)){
+                double ns = seconds * 1e9 / iterations;
+                if(bestIterations == 0 || ns < best){
+                    best = ns;
+                    bestIterations = iterations;
+                }
+                break;
+            }
+        }
+    }
+    
+    results.push_back({name, bestIterations, best, itemsPerOp});
+    std::fprintf(stderr, "%-40s %12.2f ns/op\n", name, best);
+}
+
+static void BenchPhysics(){
+    Bench("vec2/add_scale", 1, []{
+        static Vec2 position(1.0f, 2.0f);
+        Vec2 velocity(0.5f, -0.25f);
+        position += velocity * FIXED_DT;
+        DoNotOptimize(position);
+    });
+    
+    Bench("ball/update", 1, []{
+        static Ball ball(Vec2(100.0f, 100.0f), Vec2(BALL_SPEED, 0.75f * BALL_SPEED));
+        ball.update(FIXED_DT);
+        if(ball.position.x > WINDOW_WIDTH){
+            ball.position = Vec2(0.0f, 0.0f);
+        }
+        DoNotOptimize(ball);
+    });
+    
+    // Ball overlapping the left paddle's top third, and far away from it
+    Paddle paddle(Vec2(50.0f, 300.0f), Vec2(0.0f, 0.0f));
+    Ball hit(Vec2(55.0f, 290.0f), Vec2(-BALL_SPEED, 0.0f));
+    Ball miss(Vec2(640.0f, 360.0f), Vec2(-BALL_SPEED, 0.0f));
+    Ball wall(Vec2(640.0f, -2.0f), Vec2(BALL_SPEED, -BALL_SPEED));
+    
+    Bench("collision/paddle_hit", 1, [&]{
+        DoNotOptimize(hit);
+        Contact contact = CheckPaddleCollision(hit, paddle);
+        DoNotOptimize(contact);
+    });
+    Bench("collision/paddle_miss", 1, [&]{
+        DoNotOptimize(miss);
+        Contact contact = CheckPaddleCollision(miss, paddle);
+        DoNotOptimize(contact);
+    });
+    Bench("collision/wall_hit", 1, [&]{
+        DoNotOptimize(wall);
+        Contact contact = CheckWallCollision(wall);
+        DoNotOptimize(contact);
+    });
+    Bench("collision/wall_miss", 1, [&]{
+        DoNotOptimize(miss);
+        Contact contact = CheckWallCollision(miss);
+        DoNotOptimize(contact);
+    });
+    Bench("collision/swept_paddle", 1, [&]{
+        DoNotOptimize(miss);
+        SweptContact contact = SweepPaddleCollision(miss, paddle, 1000.0f);
+        DoNotOptimize(contact);
+    });
+    
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        GameState state = NewGame();
+        Inputs inputs;
+        Bench(mode == CollisionMode::Discrete ? "step/discrete" : "step/swept", 1, [&]{
+            state = Step(state, inputs, FIXED_DT, mode);
+            DoNotOptimize(state);
+        });
+    }
+    
+    // The same match in fixed point, for comparison with the float steps above
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        FixedGameState state = NewGame<Fixed>();
+        Inputs inputs;
+        Bench(mode == CollisionMode::Discrete ? "step/fixed_discrete" : "step/fixed_swept", 1, [&]{
+            state = Step(state, inputs, Constants<Fixed>::fixedDt, mode);
+            DoNotOptimize(state);
+        });
+    }
+    
+    // A ball that bounces off a wall several times before it reaches the right paddle
+    Ball shot(Vec2(60.0f, 300.0f), Vec2(BALL_SPEED, 0.75f * BALL_SPEED));
+    Bench("ai/predict", 1, [&]{
+        DoNotOptimize(shot);
+        float y = PredictBallY(shot, WINDOW_WIDTH - 50.0f - BALL_WIDTH);
+        DoNotOptimize(y);
+    });
+    
+    // What a step pays to publish its state to spectators, encoded once however many are watching
+    {
+        GameState state = NewGame();
+        Inputs inputs;
+        inputs.buttons[Buttons::PaddleLeftUp] = true;
+        SpectatorState keyframe = Quantize(state, 0);
+        uint8_t message[MAX_SPECTATOR_MESSAGE];
+        uint32_t tick = 0;
+        Bench("spectator/encode_delta", 1, [&]{
+            state = Step(state, inputs, FIXED_DT);
+            std::size_t size = EncodeDelta(keyframe, Quantize(state, ++tick), message);
+            DoNotOptimize(size);
+        });
+    }
+    
+    // One iteration lets the computer play both paddles of every match and steps them once
+    {
+        const std::size_t aiMatches = 4096;
+        std::vector<GameState> states(aiMatches, NewGame());
+        std::vector<PaddleAi> players;
+        for(std::size_t i = 0; i < aiMatches; ++i){
+            players.emplace_back(0, AiSettings{150.0f, 40.0f, static_cast<uint32_t>(2 * i + 1)});
+            players.emplace_back(1, AiSettings{150.0f, 40.0f, static_cast<uint32_t>(2 * i + 2)});
+        }
+        Bench("ai/match_4096", static_cast<double>(aiMatches), [&]{
+            for(std::size_t i = 0; i < aiMatches; ++i){
+                Inputs inputs;
+                players[2 * i].Drive(states[i], FIXED_DT, inputs);
+                players[2 * i + 1].Drive(states[i], FIXED_DT, inputs);
+                states[i] = Step(states[i], inputs, FIXED_DT);
+            }
+            DoNotOptimize(states[0]);
+        });
+    }
+    
+    // One iteration steps every match in the batch once
+    const std::size_t matches = 4096;
+    for(BatchKernel kernel : {BatchKernel::Scalar, BatchKernel::SSE2, BatchKernel::AVX2}){
+        if(static_cast<int>(kernel) > static_cast<int>(BestBatchKernel())){
+            continue;
+        }
+        BatchState batch = NewBatch(matches);
+        std::string name = std::string("batch/step_4096/") + BatchKernelName(kernel);
+        Bench(name.c_str(), static_cast<double>(matches), [&]{
+            StepBatch(batch, FIXED_DT, kernel);
+            DoNotOptimize(batch.ballX[0]);
+        });
+    }
+    
+    // One iteration steps every ball in the arena once, the time per ball should stay flat as the count grows
+    for(std::size_t balls : {256, 1024, 2048}){
+        ArenaState arena = NewArena(balls);
+        BallGrid grid;
+        Inputs inputs;
+        std::string name = "arena/step_" + std::to_string(balls);
+        Bench(name.c_str(), static_cast<double>(balls), [&]{
+            StepArena(arena, inputs, FIXED_DT, grid);
+            DoNotOptimize(arena.balls[0]);
+        });
+    }
+}
+
+#ifdef PONG_BENCH_SDL
+static void BenchRendering(){
+    // Headless: no window appears, the software renderer draws into memory
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if(SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() != 0){
+        std::fprintf(stderr, "Skipping rendering benchmarks: %s\n", SDL_GetError());
+        return;
+    }
+    
+    SDL_Window* window = SDL_CreateWindow("pong_bench", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    TTF_Font* font = TTF_OpenFontRW(OpenAsset("font/DejaVuSansMono.ttf"), 1, 40);
+    if(!renderer || !font){
+        std::fprintf(stderr, "Skipping rendering benchmarks: %s\n", SDL_GetError());
+    }else{
+        GlyphAtlas atlas(renderer, font);
+        PlayerScore left(Vec2(WINDOW_WIDTH/4.0f, 20), atlas);
+        PlayerScore right(Vec2(3 * WINDOW_WIDTH/4.0f, 20), atlas);
+        
+        // Startup cost of a font, parsed straight from the embedded bytes
+        Bench("assets/open_font", 1, [&]{
+            TTF_Font* opened = TTF_OpenFontRW(OpenAsset("font/DejaVuSansMono.ttf"), 1, 20);
+            DoNotOptimize(opened);
+            TTF_CloseFont(opened);
+        });
+        
+        int score = 0;
+        Bench("score/set_score", 1, [&]{
+            left.setScore(++score % 100);
+            DoNotOptimize(left.rect);
+        });
+        
+        // A PLAYING frame drawn the way main() draws it, including the present
+        DrawList drawList;
+        const std::vector<SDL_Rect> netRects = BuildNetRects(WINDOW_WIDTH/2, WINDOW_HEIGHT);
+        GameState state = NewGame();
+        Inputs inputs;
+        Bench("render/playing_frame", 1, [&]{
+            state = Step(state, inputs, FIXED_DT);
+            
+            SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0xFF);
+            SDL_RenderClear(renderer);
+            SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+            drawList.Clear();
+            drawList.AddRects(netRects);
+            drawList.AddRect(BallRect(state.ball, 0.5f));
+            drawList.AddRect(PaddleRect(state.paddleLeft, 0.5f));
+            drawList.AddRect(PaddleRect(state.paddleRight, 0.5f));
+            drawList.Submit(renderer);
+            left.Draw();
+            right.Draw();
+            atlas.Flush();
+            SDL_RenderPresent(renderer);
+        });
+        
+        // What --video costs per frame: the readback on the render thread, the conversion on the writer
+        std::vector<uint32_t> frame(WINDOW_WIDTH * WINDOW_HEIGHT);
+        Bench("video/read_pixels", 1, [&]{
+            SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, frame.data(), WINDOW_WIDTH * 4);
+            DoNotOptimize(frame[0]);
+        });
+        
+        std::vector<uint8_t> yuv(WINDOW_WIDTH * WINDOW_HEIGHT * 3 / 2);
+        Bench("video/argb_to_i420", 1, [&]{
+            ArgbToI420(frame.data(), WINDOW_WIDTH, WINDOW_HEIGHT, yuv.data());
+            DoNotOptimize(yuv[0]);
+        });
+    }
+    
+    if(font){
+        TTF_CloseFont(font);
+    }
+    if(renderer){
+        SDL_DestroyRenderer(renderer);
+    }
+    if(window){
+        SDL_DestroyWindow(window);
+    }
+    TTF_Quit();
+    SDL_Quit();
+}
+#endif
+
+static bool WriteJson(std::FILE* out){
+    std::fprintf(out, "{\n  \"context\": {\"batch_kernel\": \"%s\", \"min_time_s\": %g},\n  \"benchmarks\": [\n",
+                 BatchKernelName(BestBatchKernel()), benchOptions.minTime);
+    for(std::size_t i = 0; i < results.size(); ++i){
+        BenchResult const& r = results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.4f, \"items_per_second\": %.1f}%s\n",
+                     r.name.c_str(), r.iterations, r.nsPerOp, r.itemsPerOp * 1e9 / r.nsPerOp,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fputs("  ]\n}\n", out);
+    return std::ferror(out) == 0;
+}
+
+int main(int argc, char* argv[]){
+    for(int i = 1; i < argc; ++i){
+        if(std::strncmp(argv[i], "--filter=", 9) == 0){
+            benchOptions.filter = argv[i] + 9;
+        }else if(std::strncmp(argv[i], "--min-time=", 11) == 0){
+            benchOptions.minTime = std::atof(argv[i] + 11);
+        }else if(std::strncmp(argv[i], "--out=", 6) == 0){
+            benchOptions.outPath = argv[i] + 6;
+        }else{
+            std::fprintf(stderr, "Usage: %s [--filter=TEXT] [--min-time=SECONDS] [--out=PATH]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    BenchPhysics();
+#ifdef PONG_BENCH_SDL
+    BenchRendering();
+#endif
+    
+    if(!benchOptions.outPath){
+        return WriteJson(stdout) ? 0 : 1;
+    }
+    std::FILE* out = std::fopen(benchOptions.outPath, "w");
+    if(!out){
+        std::fprintf(stderr, "Can't write %s\n", benchOptions.outPath);
+        return 1;
+    }
+    bool ok = WriteJson(out);
+    return (std::fclose(out) == 0 && ok) ? 0 : 1;
+}
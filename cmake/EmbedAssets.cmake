@@ -0,0 +1,43 @@
+# Writes a C++ source holding the bytes of every asset, run at build time with cmake -P
+#   -DASSET_DIR=<directory the names are relative to>
+#   -DASSETS=<name,name,...>
+#   -DOUTPUT=<generated .cpp>
+
+set(source "// Generated by cmake/EmbedAssets.cmake from ${ASSET_DIR}, do not edit\n\n")
+string(APPEND source "#include \"assets.h\"\n\n")
+
+set(line_pattern "")
+foreach(byte RANGE 15)
+    string(APPEND line_pattern "0x..,")
+endforeach()
+
+set(table "")
+set(index 0)
+# The names arrive comma separated, a ; would split the -D argument
+string(REPLACE "," ";" ASSETS "${ASSETS}")
+foreach(name ${ASSETS})
+    file(READ "${ASSET_DIR}/${name}" hex HEX)
+    string(LENGTH "${hex}" length)
+    math(EXPR size "${length} / 2")
+    
+    # Two hex digits per byte, 16 bytes per line (CMake regexes have no {n} repeat)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    string(REGEX REPLACE "(${line_pattern})" "\\1\n    " bytes "${bytes}")
+    string(STRIP "${bytes}" bytes)
+    
+    string(APPEND source "alignas(16) static const unsigned char ASSET_${index}[] = {\n    ${bytes}\n};\n\n")
+    string(APPEND table "    {\"${name}\", ASSET_${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+string(APPEND source "const EmbeddedAsset EMBEDDED_ASSETS[] = {\n${table}};\n\n")
+string(APPEND source "const int EMBEDDED_ASSET_COUNT = ${index};\n")
+
+# Only touch the output when it changed, so an unrelated asset edit doesn't rebuild it
+set(previous "")
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+endif()
+if(NOT previous STREQUAL source)
+    file(WRITE "${OUTPUT}" "${source}")
+endif()
@@ -0,0 +1,255 @@
+#include "allocation_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <SDL2/SDL.h>
+
+// Heap allocations of this thread, counted by every allocation function below
+static thread_local uint64_t threadAllocations = 0;
+
+/*
+* The frame arena
+*   - A static block, so serving from it never touches the heap, split into ARENA_CHUNKS
+*     chunks; a frame allocates from one chunk only
+*   - Every block starts with a header holding its size; blocks are handed out from the
+*     top of the chunk. Freeing the newest block takes its room back, any other free only
+*     lowers the live count, and the top drops back to the start whenever nothing in the
+*     chunk is live
+*   - BeginArenaFrame() keeps the chunk if the last frame freed everything in it, and
+*     otherwise counts what is still live and moves on to the next chunk with nothing
+*     live. A block that outlives its frame only holds its own chunk, the frames after
+*     it carry on in the others until it is freed
+*   - Only the owning thread allocates from it, any thread may free into it
+*/
+static const std::size_t ARENA_CHUNKS = 8;
+static const std::size_t CHUNK_BYTES = 64 * 1024;
+static const std::size_t ARENA_ALIGN = 16;
+
+struct ArenaChunk{
+    std::atomic<uint32_t> live{0};
+    std::size_t top = 0;
+};
+
+alignas(ARENA_ALIGN) static unsigned char arenaMemory[ARENA_CHUNKS * CHUNK_BYTES];
+static ArenaChunk arenaChunks[ARENA_CHUNKS];
+static std::atomic<uint64_t> arenaServed{0};
+static thread_local bool arenaOwner = false;
+
+// The chunk of the current frame, -1 while every chunk holds live blocks
+static int arenaChunk = -1;
+
+static bool InArena(const void* pointer){
+    const unsigned char* address = static_cast<const unsigned char*>(pointer);
+    return address >= arenaMemory && address < arenaMemory + sizeof(arenaMemory);
+}
+
+static ArenaChunk& ChunkOf(const void* pointer){
+    return arenaChunks[(static_cast<const unsigned char*>(pointer) - arenaMemory) / CHUNK_BYTES];
+}
+
+static std::size_t& ArenaBlockSize(void* pointer){
+    return *reinterpret_cast<std::size_t*>(static_cast<unsigned char*>(pointer) - ARENA_ALIGN);
+}
+
+static std::size_t RoundUp(std::size_t size){
+    return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+// The current chunk if this thread owns the arena and `pointer` is in it, otherwise nullptr
+static ArenaChunk* OwnedChunk(const void* pointer){
+    if(!arenaOwner || arenaChunk < 0 || &ChunkOf(pointer) != &arenaChunks[arenaChunk]){
+        return nullptr;
+    }
+    return &arenaChunks[arenaChunk];
+}
+
+// Whether the block at `pointer`, `size` bytes long, ends at the top of the current chunk
+static bool AtTop(void* pointer, std::size_t size){
+    unsigned char* end = static_cast<unsigned char*>(pointer) + RoundUp(size);
+    return end == arenaMemory + arenaChunk * CHUNK_BYTES + arenaChunks[arenaChunk].top;
+}
+
+// A block from the current chunk, nullptr if this thread doesn't own the arena or the chunk is full
+static void* ArenaAllocate(std::size_t size){
+    if(!arenaOwner || arenaChunk < 0){
+        return nullptr;
+    }
+    ArenaChunk& chunk = arenaChunks[arenaChunk];
+    if(chunk.live.load(std::memory_order_acquire) == 0){
+        chunk.top = 0;
+    }
+    std::size_t need = ARENA_ALIGN + RoundUp(size);
+    if(need > CHUNK_BYTES - chunk.top){
+        return nullptr;
+    }
+    void* block = arenaMemory + arenaChunk * CHUNK_BYTES + chunk.top + ARENA_ALIGN;
+    ArenaBlockSize(block) = size;
+    chunk.top += need;
+    chunk.live.fetch_add(1, std::memory_order_relaxed);
+    arenaServed.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+static void* TrackedMalloc(std::size_t size){
+    if(void* block = ArenaAllocate(size)){
+        return block;
+    }
+    ++threadAllocations;
+    return std::malloc(size);
+}
+
+static void* TrackedCalloc(std::size_t count, std::size_t size){
+    if(size != 0 && count > static_cast<std::size_t>(-1) / size){
+        return nullptr;
+    }
+    void* block = TrackedMalloc(count * size);
+    if(block){
+        std::memset(block, 0, count * size);
+    }
+    return block;
+}
+
+static void TrackedFree(void* pointer){
+    if(InArena(pointer)){
+        ArenaChunk* owned = OwnedChunk(pointer);
+        if(owned && AtTop(pointer, ArenaBlockSize(pointer))){
+            owned->top -= ARENA_ALIGN + RoundUp(ArenaBlockSize(pointer));
+        }
+        ChunkOf(pointer).live.fetch_sub(1, std::memory_order_release);
+    }else{
+        std::free(pointer);
+    }
+}
+
+static void* TrackedRealloc(void* pointer, std::size_t size){
+    if(!InArena(pointer)){
+        // A heap block stays on the heap, realloc may move it and counts as an allocation
+        ++threadAllocations;
+        return std::realloc(pointer, size);
+    }
+    
+    // The newest block grows in place while there is room, any block shrinks in place
+    std::size_t oldSize = ArenaBlockSize(pointer);
+    if(size <= oldSize){
+        return pointer;
+    }
+    std::size_t growth = RoundUp(size) - RoundUp(oldSize);
+    ArenaChunk* owned = OwnedChunk(pointer);
+    if(owned && AtTop(pointer, oldSize) && growth <= CHUNK_BYTES - owned->top){
+        owned->top += growth;
+        ArenaBlockSize(pointer) = size;
+        return pointer;
+    }
+    
+    void* moved = TrackedMalloc(size);
+    if(moved){
+        std::memcpy(moved, pointer, oldSize);
+        TrackedFree(pointer);
+    }
+    return moved;
+}
+
+void InstallAllocationHooks(){
+    SDL_SetMemoryFunctions(TrackedMalloc, TrackedCalloc, TrackedRealloc, TrackedFree);
+}
+
+uint64_t ThreadAllocations(){
+    return threadAllocations;
+}
+
+void BeginArenaFrame(){
+    arenaOwner = true;
+    if(arenaChunk >= 0){
+        ArenaChunk& chunk = arenaChunks[arenaChunk];
+        uint32_t live = chunk.live.load(std::memory_order_acquire);
+        if(live == 0){
+            chunk.top = 0;
+            return;
+        }
+        
+        // Outlived their frame, counted once here as the frame moves on to another chunk
+        threadAllocations += live;
+    }
+    
+    int previous = arenaChunk;
+    arenaChunk = -1;
+    for(int i = 1; i <= static_cast<int>(ARENA_CHUNKS); ++i){
+        int candidate = (previous + i) % static_cast<int>(ARENA_CHUNKS);
+        if(arenaChunks[candidate].live.load(std::memory_order_acquire) == 0){
+            arenaChunks[candidate].top = 0;
+            arenaChunk = candidate;
+            break;
+        }
+    }
+}
+
+uint64_t ArenaAllocations(){
+    return arenaServed.load(std::memory_order_relaxed);
+}
+
+bool AllocationCheck::Check(int screen, uint64_t allocations){
+    if(screen != this->screen){
+        this->screen = screen;
+        screenFrames = 0;
+    }
+    if(++screenFrames <= WARMUP_FRAMES){
+        return false;
+    }
+    
+    --remaining;
+    if(allocations == 0){
+        return false;
+    }
+    ++failedFrames;
+    return true;
+}
+
+/*
+* Global operator new and delete, counted
+*   - They never use the frame arena: a C++ object outliving its frame is the common case,
+*     and our own code is expected not to allocate per frame at all
+*/
+static void* CountedNew(std::size_t size){
+    ++threadAllocations;
+    void* block = std::malloc(size ? size : 1);
+    if(!block){
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+static void* CountedAlignedNew(std::size_t size, std::align_val_t alignment){
+    ++threadAllocations;
+    std::size_t align = static_cast<std::size_t>(alignment);
+    void* block = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if(!block){
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void* operator new(std::size_t size){ return CountedNew(size); }
+void* operator new[](std::size_t size){ return CountedNew(size); }
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept{
+    ++threadAllocations;
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept{
+    ++threadAllocations;
+    return std::malloc(size ? size : 1);
+}
+void* operator new(std::size_t size, std::align_val_t alignment){ return CountedAlignedNew(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment){ return CountedAlignedNew(size, alignment); }
+
+void operator delete(void* pointer) noexcept{ std::free(pointer); }
+void operator delete[](void* pointer) noexcept{ std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept{ std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept{ std::free(pointer); }
+void operator delete(void* pointer, std::nothrow_t const&) noexcept{ std::free(pointer); }
+void operator delete[](void* pointer, std::nothrow_t const&) noexcept{ std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept{ std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept{ std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept{ std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept{ std::free(pointer); }
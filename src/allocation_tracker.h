@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+* Allocation accounting for the frontend
+*   - Global operator new and delete are replaced, and SDL's allocator (which SDL_ttf and
+*     SDL_mixer use too) is hooked with SDL_SetMemoryFunctions, so every heap allocation
+*     made by our code or SDL is counted
+*   - Counts are kept per thread, so the render thread can attribute its own allocations
+*     to profiler phases while the simulation and audio threads run
+*   - SDL allocations on the thread that calls BeginArenaFrame() come out of a fixed frame
+*     arena instead of the heap. SDL frees its scratch buffers (like the float copy
+*     SDL_RenderFillRects makes of the rects) before the call returns, so those cost no
+*     heap allocation. A block still live at the next BeginArenaFrame() outlived its frame
+*     and is counted once, as an allocation of that frame
+*   - The arena is split into chunks and a frame only allocates from one, so a block that
+*     lives on only keeps its own chunk from being reused until it is freed. Once every
+*     chunk holds one, frames allocate from the heap
+*/
+
+// Hooks SDL's allocator, call before SDL_Init so every SDL allocation goes through it
+void InstallAllocationHooks();
+
+// Heap allocations made by the calling thread so far, plus arena blocks that outlived their frame
+uint64_t ThreadAllocations();
+
+/*
+* Starts a new frame of the frame arena for the calling thread, which becomes the only one
+* it serves; the blocks of the previous frame that are still live are counted first
+*/
+void BeginArenaFrame();
+
+// SDL allocations served by the frame arena so far
+uint64_t ArenaAllocations();
+
+/*
+* The --alloc-check test mode
+*   - Frames are counted per screen; the first WARMUP_FRAMES after a change of screen may
+*     allocate while buffers grow to their steady size, every frame after that must not
+*   - Done() once the given number of frames has been checked
+*/
+class AllocationCheck{
+    public:
+        static const int WARMUP_FRAMES = 60;
+        
+        explicit AllocationCheck(int frames) : remaining(frames) {}
+        
+        // Charges `allocations` to a frame shown on `screen`, true if the frame was checked and allocated
+        bool Check(int screen, uint64_t allocations);
+        
+        bool Done() const { return remaining <= 0; }
+        uint64_t FailedFrames() const { return failedFrames; }
+        
+    private:
+        int remaining;
+        int screen = -1;
+        int screenFrames = 0;
+        uint64_t failedFrames = 0;
+};
@@ -0,0 +1,22 @@
+#include "assets.h"
+
+#include <cstring>
+
+const EmbeddedAsset* FindAsset(const char* name){
+    // A handful of assets, looked up a few times at startup
+    for(int i = 0; i < EMBEDDED_ASSET_COUNT; ++i){
+        if(std::strcmp(EMBEDDED_ASSETS[i].name, name) == 0){
+            return &EMBEDDED_ASSETS[i];
+        }
+    }
+    SDL_Log("No embedded asset called %s", name);
+    return nullptr;
+}
+
+SDL_RWops* OpenAsset(const char* name){
+    const EmbeddedAsset* asset = FindAsset(name);
+    if(!asset){
+        return nullptr;
+    }
+    return SDL_RWFromConstMem(asset->data, static_cast<int>(asset->size));
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <SDL2/SDL.h>
+
+/*
+* Fonts and sounds compiled into the binary (see cmake/EmbedAssets.cmake)
+*   - The game needs no files next to it and can be started from any directory
+*   - Names are paths relative to assets/, e.g. "font/DejaVuSansMono.ttf"
+*/
+struct EmbeddedAsset{
+    const char* name;
+    const unsigned char* data;
+    std::size_t size;
+};
+
+extern const EmbeddedAsset EMBEDDED_ASSETS[];
+extern const int EMBEDDED_ASSET_COUNT;
+
+// The embedded asset called `name`, nullptr (with the name logged) if there is none
+const EmbeddedAsset* FindAsset(const char* name);
+
+/*
+* A read-only stream over an embedded asset's bytes, nullptr if there is no such asset
+*   - Nothing is copied, so opening the same font at several sizes shares one copy of it
+*   - Hand it to an SDL loader that frees it, e.g. TTF_OpenFontRW(OpenAsset(name), 1, size)
+*/
+SDL_RWops* OpenAsset(const char* name);
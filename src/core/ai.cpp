@@ -0,0 +1,85 @@
+#include "core/ai.h"
+
+#include <cmath>
+
+namespace pong {
+
+// xorshift32, the same generator the arena serves with, from -1 to 1
+static float RandomSigned(uint32_t& state){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+float PredictBallY(Ball const& ball, float x){
+    if(ball.velocity.x == 0.0f){
+        return ball.position.y;
+    }
+    
+    // Where the ball would be without walls
+    float time = (x - ball.position.x) / ball.velocity.x;
+    float y = ball.position.y + ball.velocity.y * time;
+    
+    // Fold it back: one period is a trip down the field and back up again
+    float travel = static_cast<float>(WINDOW_HEIGHT - BALL_HEIGHT);
+    float folded = std::fmod(y, 2.0f * travel);
+    if(folded < 0.0f){
+        folded += 2.0f * travel;
+    }
+    return (folded > travel) ? 2.0f * travel - folded : folded;
+}
+
+PaddleAi::PaddleAi(int player, AiSettings const& settings)
+    : player(player), settings(settings), random(settings.seed ? settings.seed : 1){
+}
+
+float PaddleAi::Decide(GameState const& state){
+    Ball const& ball = state.ball;
+    Paddle const& paddle = (player == 0) ? state.paddleLeft : state.paddleRight;
+    
+    // Wait in the middle while the ball is going the other way
+    bool incoming = (player == 0) ? ball.velocity.x < 0.0f : ball.velocity.x > 0.0f;
+    if(!incoming){
+        return WINDOW_HEIGHT / 2.0f;
+    }
+    
+    // The ball's left edge at the paddle's front face
+    float contactX = (player == 0) ? paddle.position.x + PADDLE_WIDTH : paddle.position.x - BALL_WIDTH;
+    float center = PredictBallY(ball, contactX) + BALL_HEIGHT / 2.0f;
+    return center + RandomSigned(random) * settings.errorPx;
+}
+
+void PaddleAi::Drive(GameState const& state, float dt, Inputs& inputs){
+    Ball const& ball = state.ball;
+    
+    // A new shot: the ball was hit or served. Wall bounces only flip velocity.y and don't change the intercept
+    float speedY = std::fabs(ball.velocity.y);
+    if(ball.velocity.x != shotVelocityX || speedY != shotSpeedY){
+        shotVelocityX = ball.velocity.x;
+        shotSpeedY = speedY;
+        reactionLeft = settings.reactionMs;
+        reacted = false;
+    }
+    
+    // React once the delay is over, the prediction is just as good from anywhere along the shot
+    if(!reacted){
+        reactionLeft -= dt;
+        if(reactionLeft <= 0.0f){
+            target = Decide(state);
+            reacted = true;
+        }
+    }
+    
+    // Stop once the next step would overshoot, so the paddle doesn't jitter around the target
+    Paddle const& paddle = (player == 0) ? state.paddleLeft : state.paddleRight;
+    float offset = target - (paddle.position.y + state.rules.paddleHeight / 2.0f);
+    float reach = state.rules.paddleSpeed * dt;
+    
+    int up = (player == 0) ? Buttons::PaddleLeftUp : Buttons::PaddleRightUp;
+    int down = (player == 0) ? Buttons::PaddleLeftDown : Buttons::PaddleRightDown;
+    inputs.buttons[up] = offset < -reach;
+    inputs.buttons[down] = offset > reach;
+}
+
+} // namespace pong
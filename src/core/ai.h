@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* How well a computer-controlled paddle plays
+*   - reactionMs is how long after the ball changes course (a paddle hit or a serve)
+*     the paddle starts moving for the new shot, until then it keeps its old plan
+*   - errorPx is how far the paddle's aim may be off, either way, drawn again for every shot
+*   - The paddle still reaches a ball it aims up to about 60 px off (half its height plus
+*     half the ball's), so errorPx is what makes it miss. Measured with pong_tournament at
+*     the default rules, the share of shots missed is about 5% at 65, 1 in 7 at 80 (the
+*     default, around 6 hits per point), 1 in 4 at 100 and 2 in 5 at 150; below 60 it
+*     practically never misses
+*   - reactionMs costs nothing until the ball can cross half the field before the paddle
+*     moves: from about 450 ms a serve from the center is missed almost every time
+*/
+struct AiSettings{
+    float reactionMs = 150.0f;
+    float errorPx = 80.0f;
+    uint32_t seed = 1;
+};
+
+/*
+* The height of the ball's top edge once its left edge reaches `x`, bouncing off the top and bottom walls
+*   - Closed form: the field mirrored at every wall repeats every 2 * (WINDOW_HEIGHT - BALL_HEIGHT),
+*     so the straight-line height is folded back into the field, O(1) however many bounces
+*   - Exact for CollisionMode::Swept, within a few pixels per bounce for Discrete,
+*     which clamps the ball to the wall instead of reflecting it
+*   - Paddles in the way are ignored, and a ball not moving horizontally never gets there,
+*     its current height is returned
+*/
+float PredictBallY(Ball const& ball, float x);
+
+/*
+* A computer player for one paddle, driving it through the same buttons as the keyboard
+*   - Player 0 drives the left paddle, player 1 the right paddle, like PlayerInputFrom()
+*   - One prediction per shot, the steps in between only compare the paddle with its
+*     target, so thousands of matches can each have one at little cost
+*   - Deterministic: the same states and settings press the same buttons
+*   - Copyable, with no allocation, like GameState
+*/
+class PaddleAi{
+    public:
+        PaddleAi() = default;
+        PaddleAi(int player, AiSettings const& settings);
+        
+        // Sets this player's buttons in `inputs` for the next `dt` step of `state`, leaves the others alone
+        void Drive(GameState const& state, float dt, Inputs& inputs);
+        
+        int Player() const { return player; }
+        
+    private:
+        // Where the paddle's center should go for the ball as it is now
+        float Decide(GameState const& state);
+        
+        int player = 0;
+        AiSettings settings;
+        uint32_t random = 1;
+        
+        // The ball's course when the current shot was noticed
+        float shotVelocityX = 0.0f;
+        float shotSpeedY = -1.0f;
+        
+        // Milliseconds until the paddle reacts to the current shot, and where it is heading
+        float reactionLeft = 0.0f;
+        bool reacted = false;
+        float target = WINDOW_HEIGHT / 2.0f;
+};
+
+} // namespace pong
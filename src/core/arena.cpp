@@ -0,0 +1,149 @@
+#include "core/arena.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/collision.h"
+
+namespace pong {
+
+// xorshift32, small enough to keep in the copyable state
+static float RandomUnit(uint32_t& state){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// A ball in the middle column at a random height, moving towards `direction` at a random angle
+static Ball Serve(uint32_t& random, float x, float direction){
+    float y = RandomUnit(random) * (WINDOW_HEIGHT - BALL_HEIGHT);
+    float slope = (RandomUnit(random) * 1.5f - 0.75f) * BALL_SPEED;
+    return Ball(Vec2(x, y), Vec2(direction * BALL_SPEED, slope));
+}
+
+ArenaState NewArena(std::size_t ballCount, uint32_t seed){
+    GameState match = NewGame();
+    
+    ArenaState arena;
+    arena.paddleLeft = match.paddleLeft;
+    arena.paddleRight = match.paddleRight;
+    arena.random = seed ? seed : 1;
+    
+    // Spread the balls over the field between the paddles, half of them going each way
+    float left = match.paddleLeft.position.x + PADDLE_WIDTH + BALL_WIDTH;
+    float right = match.paddleRight.position.x - 2.0f * BALL_WIDTH;
+    arena.balls.reserve(ballCount);
+    for(std::size_t i = 0; i < ballCount; ++i){
+        float x = left + RandomUnit(arena.random) * (right - left);
+        arena.balls.push_back(Serve(arena.random, x, (i % 2) ? -1.0f : 1.0f));
+    }
+    return arena;
+}
+
+static int CellCoordinate(float position, int cells){
+    int cell = static_cast<int>(position) / BallGrid::CELL_SIZE;
+    return std::min(std::max(cell, 0), cells - 1);
+}
+
+void BallGrid::Build(std::vector<Ball> const& balls){
+    const int cells = COLUMNS * ROWS;
+    cellStart.assign(cells + 1, 0);
+    sorted.resize(balls.size());
+    ballCell.resize(balls.size());
+    
+    // Count the balls per cell and sum the counts up to where each cell ends
+    for(std::size_t i = 0; i < balls.size(); ++i){
+        int column = CellCoordinate(balls[i].position.x, COLUMNS);
+        int row = CellCoordinate(balls[i].position.y, ROWS);
+        ballCell[i] = static_cast<uint32_t>(row * COLUMNS + column);
+        ++cellStart[ballCell[i]];
+    }
+    for(int cell = 1; cell <= cells; ++cell){
+        cellStart[cell] += cellStart[cell - 1];
+    }
+    
+    // Filling each cell from its end, in reverse, leaves every entry at its cell's start and keeps balls in index order
+    for(std::size_t i = balls.size(); i-- > 0;){
+        sorted[--cellStart[ballCell[i]]] = static_cast<uint32_t>(i);
+    }
+}
+
+/*
+* Separates two overlapping balls along the axis they overlap least and bounces them
+*   - Equal masses in an elastic collision just swap their velocities along that axis
+*   - Balls already moving apart are only separated, so they don't stick together
+*/
+static bool CollideBalls(Ball& a, Ball& b){
+    float overlapX = BALL_WIDTH - std::abs(a.position.x - b.position.x);
+    float overlapY = BALL_HEIGHT - std::abs(a.position.y - b.position.y);
+    if(overlapX <= 0.0f || overlapY <= 0.0f)
+        return false;
+    
+    if(overlapX < overlapY){
+        float side = (a.position.x < b.position.x) ? -1.0f : 1.0f;
+        a.position.x += side * overlapX * 0.5f;
+        b.position.x -= side * overlapX * 0.5f;
+        if((b.velocity.x - a.velocity.x) * side > 0.0f){
+            std::swap(a.velocity.x, b.velocity.x);
+        }
+    }else{
+        float side = (a.position.y < b.position.y) ? -1.0f : 1.0f;
+        a.position.y += side * overlapY * 0.5f;
+        b.position.y -= side * overlapY * 0.5f;
+        if((b.velocity.y - a.velocity.y) * side > 0.0f){
+            std::swap(a.velocity.y, b.velocity.y);
+        }
+    }
+    return true;
+}
+
+void StepArena(ArenaState& arena, Inputs const& inputs, float dt, BallGrid& grid, InputEvent const* events, int eventCount){
+    arena.events = EVENT_NONE;
+    
+    // The paddles move exactly like in a match
+    GameState paddles;
+    paddles.paddleLeft = arena.paddleLeft;
+    paddles.paddleRight = arena.paddleRight;
+    Inputs held = inputs;
+    UpdatePaddlesTimed(paddles, held, events, eventCount, dt);
+    arena.paddleLeft = paddles.paddleLeft;
+    arena.paddleRight = paddles.paddleRight;
+    
+    for(Ball& ball : arena.balls){
+        ball.update(dt);
+    }
+    
+    // Broad phase, then the exact test on the candidate pairs only
+    grid.Build(arena.balls);
+    grid.ForEachPair([&](uint32_t a, uint32_t b){
+        if(CollideBalls(arena.balls[a], arena.balls[b])){
+            arena.events |= EVENT_BALL_HIT;
+        }
+    });
+    
+    for(Ball& ball : arena.balls){
+        if(Contact contact = CheckPaddleCollision(ball, arena.paddleLeft); contact.type != CollisionType::None){
+            ball.CollideWithPaddle(contact);
+            arena.events |= EVENT_PADDLE_HIT;
+        }else if(contact = CheckPaddleCollision(ball, arena.paddleRight); contact.type != CollisionType::None){
+            ball.CollideWithPaddle(contact);
+            arena.events |= EVENT_PADDLE_HIT;
+        }else if(contact = CheckWallCollision(ball); contact.type != CollisionType::None){
+            if(contact.type == CollisionType::Left){
+                ++arena.rightScore;
+                arena.events |= EVENT_RIGHT_SCORED;
+                ball = Serve(arena.random, WINDOW_WIDTH / 2.0f - BALL_WIDTH / 2.0f, 1.0f);
+            }else if(contact.type == CollisionType::Right){
+                ++arena.leftScore;
+                arena.events |= EVENT_LEFT_SCORED;
+                ball = Serve(arena.random, WINDOW_WIDTH / 2.0f - BALL_WIDTH / 2.0f, -1.0f);
+            }else{
+                ball.CollideWithWall(contact);
+                arena.events |= EVENT_WALL_HIT;
+            }
+        }
+    }
+}
+
+} // namespace pong
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* Arena mode: any number of balls on one field, bouncing off the paddles, the walls and each other
+*   - A ball leaving the field scores like in a match and is served again from
+*     the middle, at a random height and angle so served balls don't stack up
+*   - Collisions are discrete, like CollisionMode::Discrete
+*/
+struct ArenaState{
+    std::vector<Ball> balls;
+    Paddle paddleLeft;
+    Paddle paddleRight;
+    int leftScore = 0;
+    int rightScore = 0;
+    unsigned events = EVENT_NONE;
+    
+    // Serves are random but reproducible, this is the generator's state
+    uint32_t random = 1;
+};
+
+/*
+* Broad phase for ball-ball collisions: a uniform grid over the field
+*   - A cell is larger than a ball, so two overlapping balls are always in the same
+*     or neighbouring cells, and only those pairs need an exact test
+*   - Rebuilt every step with a counting sort, O(balls + cells) and no allocation
+*     once the buffers have grown to the ball count
+*   - Balls outside the field are clamped into the border cells
+*/
+class BallGrid{
+    public:
+        static const int CELL_SIZE = 16;
+        static const int COLUMNS = (WINDOW_WIDTH + CELL_SIZE - 1) / CELL_SIZE;
+        static const int ROWS = (WINDOW_HEIGHT + CELL_SIZE - 1) / CELL_SIZE;
+        static_assert(CELL_SIZE > BALL_WIDTH && CELL_SIZE > BALL_HEIGHT, "overlapping balls must be in neighbouring cells");
+        
+        void Build(std::vector<Ball> const& balls);
+        
+        /*
+        * Calls visit(a, b) once for every pair of balls in the same or neighbouring cells
+        *   - Each ball is paired with the balls after it in its own cell and with every ball
+        *     in the cells right and below its cell, which covers each neighbouring pair once
+        *   - Walks the balls rather than the cells, so empty cells cost nothing
+        */
+        template<typename Visit>
+        void ForEachPair(Visit&& visit) const{
+            static const int NEIGHBOURS[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+            
+            for(uint32_t a = 0; a < sorted.size(); ++a){
+                uint32_t ball = sorted[a];
+                uint32_t cell = ballCell[ball];
+                int column = static_cast<int>(cell % COLUMNS);
+                int row = static_cast<int>(cell / COLUMNS);
+                
+                for(uint32_t b = a + 1; b < cellStart[cell + 1]; ++b){
+                    visit(ball, sorted[b]);
+                }
+                
+                for(auto const& offset : NEIGHBOURS){
+                    int neighbourColumn = column + offset[0];
+                    int neighbourRow = row + offset[1];
+                    if(neighbourColumn >= COLUMNS || neighbourRow < 0 || neighbourRow >= ROWS)
+                        continue;
+                    
+                    int neighbour = neighbourRow * COLUMNS + neighbourColumn;
+                    for(uint32_t b = cellStart[neighbour]; b < cellStart[neighbour + 1]; ++b){
+                        visit(ball, sorted[b]);
+                    }
+                }
+            }
+        }
+        
+    private:
+        // Balls of cell c are sorted[cellStart[c]] to sorted[cellStart[c + 1] - 1]
+        std::vector<uint32_t> cellStart;
+        std::vector<uint32_t> sorted;
+        std::vector<uint32_t> ballCell;
+};
+
+// Returns an arena with `ballCount` balls spread over the middle of the field
+ArenaState NewArena(std::size_t ballCount, uint32_t seed = 1);
+
+/*
+* Advances the arena by `dt` milliseconds with the given inputs held
+*   - Moves the paddles and balls, separates and bounces overlapping balls,
+*     then resolves paddles and walls per ball like a match step does
+*   - `grid` is scratch space, reuse the same one every step to avoid allocating
+*   - Buttons changing during the step can be passed as `events`, see UpdatePaddlesTimed()
+*/
+void StepArena(ArenaState& arena, Inputs const& inputs, float dt, BallGrid& grid,
+               InputEvent const* events = nullptr, int eventCount = 0);
+
+} // namespace pong
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "core/constants.h"
+#include "core/vec2.h"
+
+namespace pong {
+
+// Stores the type of collision
+enum class CollisionType{
+    None,
+    Top,
+    Middle,
+    Bottom,
+    Left,
+    Right
+};
+
+// Stores the collision information
+template<typename T>
+struct BasicContact{
+    CollisionType type;
+    T penetration;
+};
+
+using Contact = BasicContact<float>;
+
+// The ball, in scalar type T (float or Fixed)
+template<typename T>
+class BasicBall{
+    public:
+        using C = Constants<T>;
+        
+        BasicVec2<T> position;
+        BasicVec2<T> previousPosition;
+        BasicVec2<T> velocity;
+        
+        BasicBall() = default;
+        BasicBall(BasicVec2<T> position, BasicVec2<T> velocity): position(position), previousPosition(position), velocity(velocity){}
+        
+        void update(T dt){
+            previousPosition = position;
+            position += velocity * dt;
+        }
+        
+        // `speed` is the ball's speed, BALL_SPEED unless the rules change it
+        void CollideWithPaddle(BasicContact<T> const& contact, T speed = C::ballSpeed){
+            position.x += contact.penetration;
+            velocity.x = -velocity.x;
+            
+            if (contact.type == CollisionType::Top) {
+                velocity.y = -(C::deflection * speed);
+            } else if (contact.type == CollisionType::Bottom) {
+                velocity.y = C::deflection * speed;
+            }
+        }
+        
+        /*
+        * CollideWithWall function is called when the ball collides with the wall
+        *  - If the ball collides with the top or bottom wall, the y velocity is reversed
+        *  - If the ball collides with the left or right wall, the ball is reset to the center
+        */
+        void CollideWithWall(BasicContact<T> const& contact, T speed = C::ballSpeed){
+            if((contact.type == CollisionType::Top) ||contact.type == CollisionType::Bottom){
+                position.y += contact.penetration;
+                velocity.y = -velocity.y;
+            }else if(contact.type == CollisionType::Left){
+                position.x = C::windowWidth * T(0.5f);
+                position.y = C::windowHeight * T(0.5f);
+                velocity.x = speed;
+                velocity.y = C::deflection * speed;
+                
+                // Snap instead of interpolating across the whole field
+                previousPosition = position;
+            }else if(contact.type == CollisionType::Right){
+                position.x = C::windowWidth * T(0.5f);
+                position.y = C::windowHeight * T(0.5f);
+                velocity.x = -speed;
+                velocity.y = C::deflection * speed;
+                previousPosition = position;
+            }
+        }
+};
+
+using Ball = BasicBall<float>;
+
+} // namespace pong
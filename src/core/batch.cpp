@@ -0,0 +1,212 @@
+#include "core/batch.h"
+
+#include <cstring>
+
+#include "core/batch_kernel.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PONG_HAVE_SSE2 1
+#endif
+
+namespace pong {
+
+namespace batch_detail {
+
+namespace {
+
+// One match at a time, used on CPUs without SIMD and for the tail of the batch
+struct ScalarOps{
+    using F = float;
+    using M = bool;
+    using I = uint32_t;
+    static constexpr std::size_t WIDTH = 1;
+    
+    static F set1(float v){ return v; }
+    static M set1mask(){ return true; }
+    static F load(const float* p){ return *p; }
+    static void store(float* p, F v){ *p = v; }
+    static I loadi(const void* p){ I v; std::memcpy(&v, p, sizeof(v)); return v; }
+    static void storei(void* p, I v){ std::memcpy(p, &v, sizeof(v)); }
+    
+    static F add(F a, F b){ return a + b; }
+    static F sub(F a, F b){ return a - b; }
+    static F mul(F a, F b){ return a * b; }
+    static F neg(F a){ return -a; }
+    static M lt(F a, F b){ return a < b; }
+    static M gt(F a, F b){ return a > b; }
+    
+    static M and_(M a, M b){ return a && b; }
+    static M or_(M a, M b){ return a || b; }
+    static M andnot(M a, M b){ return !a && b; }
+    static F select(M m, F a, F b){ return m ? a : b; }
+    static M select(M m, M a, M b){ return m ? a : b; }
+    
+    static M testBit(I buttons, uint32_t bit){ return (buttons >> bit) & 1u; }
+    static I maskToInt(M m){ return m ? ~0u : 0u; }
+    static I subi(I a, I b){ return a - b; }
+    static I andi(I a, uint32_t b){ return a & b; }
+    static I ori(I a, I b){ return a | b; }
+};
+
+#ifdef PONG_HAVE_SSE2
+// Four matches per register, SSE2 is always available on x86-64
+struct Sse2Ops{
+    using F = __m128;
+    using M = __m128;
+    using I = __m128i;
+    static constexpr std::size_t WIDTH = 4;
+    
+    static F set1(float v){ return _mm_set1_ps(v); }
+    static M set1mask(){ return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static F load(const float* p){ return _mm_loadu_ps(p); }
+    static void store(float* p, F v){ _mm_storeu_ps(p, v); }
+    static I loadi(const void* p){ return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+    static void storei(void* p, I v){ _mm_storeu_si128(static_cast<__m128i*>(p), v); }
+    
+    static F add(F a, F b){ return _mm_add_ps(a, b); }
+    static F sub(F a, F b){ return _mm_sub_ps(a, b); }
+    static F mul(F a, F b){ return _mm_mul_ps(a, b); }
+    static F neg(F a){ return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    static M lt(F a, F b){ return _mm_cmplt_ps(a, b); }
+    static M gt(F a, F b){ return _mm_cmpgt_ps(a, b); }
+    
+    static M and_(M a, M b){ return _mm_and_ps(a, b); }
+    static M or_(M a, M b){ return _mm_or_ps(a, b); }
+    static M andnot(M a, M b){ return _mm_andnot_ps(a, b); }
+    
+    // SSE2 has no blend instruction, so combine the two sides with the mask
+    static F select(M m, F a, F b){ return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    
+    static M testBit(I buttons, uint32_t bit){
+        I flag = _mm_set1_epi32(static_cast<int>(1u << bit));
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(buttons, flag), flag));
+    }
+    static I maskToInt(M m){ return _mm_castps_si128(m); }
+    static I subi(I a, I b){ return _mm_sub_epi32(a, b); }
+    static I andi(I a, uint32_t b){ return _mm_and_si128(a, _mm_set1_epi32(static_cast<int>(b))); }
+    static I ori(I a, I b){ return _mm_or_si128(a, b); }
+};
+#endif
+
+} // namespace
+
+} // namespace batch_detail
+
+using batch_detail::BatchArrays;
+
+BatchState NewBatch(std::size_t count){
+    BatchState batch;
+    batch.count = count;
+    batch.ballX.resize(count);
+    batch.ballY.resize(count);
+    batch.ballVelocityX.resize(count);
+    batch.ballVelocityY.resize(count);
+    batch.paddleLeftY.resize(count);
+    batch.paddleRightY.resize(count);
+    batch.leftScore.resize(count);
+    batch.rightScore.resize(count);
+    batch.buttons.resize(count);
+    batch.events.resize(count);
+    
+    GameState fresh = NewGame();
+    for(std::size_t i = 0; i < count; ++i){
+        SetMatch(batch, i, fresh);
+    }
+    return batch;
+}
+
+void SetMatch(BatchState& batch, std::size_t index, GameState const& state){
+    batch.ballX[index] = state.ball.position.x;
+    batch.ballY[index] = state.ball.position.y;
+    batch.ballVelocityX[index] = state.ball.velocity.x;
+    batch.ballVelocityY[index] = state.ball.velocity.y;
+    batch.paddleLeftY[index] = state.paddleLeft.position.y;
+    batch.paddleRightY[index] = state.paddleRight.position.y;
+    batch.leftScore[index] = state.leftScore;
+    batch.rightScore[index] = state.rightScore;
+    batch.events[index] = state.events;
+}
+
+GameState GetMatch(BatchState const& batch, std::size_t index){
+    GameState state = NewGame();
+    state.ball.position = Vec2(batch.ballX[index], batch.ballY[index]);
+    state.ball.previousPosition = state.ball.position;
+    state.ball.velocity = Vec2(batch.ballVelocityX[index], batch.ballVelocityY[index]);
+    state.paddleLeft.position.y = batch.paddleLeftY[index];
+    state.paddleLeft.previousPosition = state.paddleLeft.position;
+    state.paddleRight.position.y = batch.paddleRightY[index];
+    state.paddleRight.previousPosition = state.paddleRight.position;
+    state.leftScore = batch.leftScore[index];
+    state.rightScore = batch.rightScore[index];
+    state.events = batch.events[index];
+    return state;
+}
+
+uint32_t PackButtons(Inputs const& inputs){
+    uint32_t mask = 0;
+    for(uint32_t i = 0; i < 4; ++i){
+        if(inputs.buttons[i]){
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+BatchKernel BestBatchKernel(){
+#if defined(PONG_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    if(__builtin_cpu_supports("avx2")){
+        return BatchKernel::AVX2;
+    }
+#endif
+#ifdef PONG_HAVE_SSE2
+    return BatchKernel::SSE2;
+#else
+    return BatchKernel::Scalar;
+#endif
+}
+
+const char* BatchKernelName(BatchKernel kernel){
+    switch(kernel){
+        case BatchKernel::Scalar:
+            return "scalar";
+        case BatchKernel::SSE2:
+            return "sse2";
+        case BatchKernel::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+void StepBatch(BatchState& batch, float dt, BatchKernel kernel){
+    BatchArrays arrays{
+        batch.ballX.data(), batch.ballY.data(),
+        batch.ballVelocityX.data(), batch.ballVelocityY.data(),
+        batch.paddleLeftY.data(), batch.paddleRightY.data(),
+        batch.leftScore.data(), batch.rightScore.data(),
+        batch.buttons.data(), batch.events.data()
+    };
+    
+    // Never run a kernel the CPU doesn't support
+    BatchKernel best = BestBatchKernel();
+    if(static_cast<int>(kernel) > static_cast<int>(best)){
+        kernel = best;
+    }
+    
+    // The SIMD kernels handle whole registers, whatever is left over is stepped one by one
+    std::size_t done = 0;
+#ifdef PONG_HAVE_AVX2
+    if(kernel == BatchKernel::AVX2){
+        done = batch_detail::StepLanesAvx2(arrays, batch.count, dt);
+    }
+#endif
+#ifdef PONG_HAVE_SSE2
+    if(kernel == BatchKernel::SSE2){
+        done = batch.count - batch.count % batch_detail::Sse2Ops::WIDTH;
+        batch_detail::StepLanes<batch_detail::Sse2Ops>(arrays, 0, done, dt);
+    }
+#endif
+    batch_detail::StepLanes<batch_detail::ScalarOps>(arrays, done, batch.count, dt);
+}
+
+} // namespace pong
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* Many independent matches stored as a structure of arrays
+*   - Element i of every array belongs to match i, so the step kernels can load
+*     4 (SSE2) or 8 (AVX2) matches into one register and resolve them together
+*   - The paddles never move horizontally, so only their y coordinates are stored
+*   - buttons holds the inputs for the next step as a bit mask, bit n is pong::Buttons n
+*   - events holds the StepEvent flags produced by the last step
+*/
+struct BatchState{
+    std::size_t count = 0;
+    std::vector<float> ballX;
+    std::vector<float> ballY;
+    std::vector<float> ballVelocityX;
+    std::vector<float> ballVelocityY;
+    std::vector<float> paddleLeftY;
+    std::vector<float> paddleRightY;
+    std::vector<int32_t> leftScore;
+    std::vector<int32_t> rightScore;
+    std::vector<uint32_t> buttons;
+    std::vector<uint32_t> events;
+};
+
+// Which implementation of the batch step to run
+enum class BatchKernel{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Returns `count` fresh matches, each equal to NewGame()
+BatchState NewBatch(std::size_t count);
+
+// Copies a single match in or out of the batch
+void SetMatch(BatchState& batch, std::size_t index, GameState const& state);
+GameState GetMatch(BatchState const& batch, std::size_t index);
+
+// Packs the held buttons into the bit mask stored in BatchState::buttons
+uint32_t PackButtons(Inputs const& inputs);
+
+// The fastest kernel this CPU supports
+BatchKernel BestBatchKernel();
+
+const char* BatchKernelName(BatchKernel kernel);
+
+/*
+* Advances every match in the batch by `dt` milliseconds using BatchState::buttons
+*   - Applies the same rules as pong::Step, match by match
+*   - If the requested kernel isn't available, the best available one is used
+*/
+void StepBatch(BatchState& batch, float dt, BatchKernel kernel = BestBatchKernel());
+
+} // namespace pong
@@ -0,0 +1,59 @@
+/*
+* AVX2 version of the batch step, eight matches per register.
+*   - This is the only file built with AVX2 enabled, StepBatch() only calls
+*     into it after checking that the CPU supports AVX2
+*/
+#include <immintrin.h>
+
+#include "core/batch_kernel.h"
+
+namespace pong {
+namespace batch_detail {
+
+namespace {
+
+struct Avx2Ops{
+    using F = __m256;
+    using M = __m256;
+    using I = __m256i;
+    static constexpr std::size_t WIDTH = 8;
+    
+    static F set1(float v){ return _mm256_set1_ps(v); }
+    static M set1mask(){ return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static F load(const float* p){ return _mm256_loadu_ps(p); }
+    static void store(float* p, F v){ _mm256_storeu_ps(p, v); }
+    static I loadi(const void* p){ return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+    static void storei(void* p, I v){ _mm256_storeu_si256(static_cast<__m256i*>(p), v); }
+    
+    static F add(F a, F b){ return _mm256_add_ps(a, b); }
+    static F sub(F a, F b){ return _mm256_sub_ps(a, b); }
+    static F mul(F a, F b){ return _mm256_mul_ps(a, b); }
+    static F neg(F a){ return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    static M lt(F a, F b){ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static M gt(F a, F b){ return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    
+    static M and_(M a, M b){ return _mm256_and_ps(a, b); }
+    static M or_(M a, M b){ return _mm256_or_ps(a, b); }
+    static M andnot(M a, M b){ return _mm256_andnot_ps(a, b); }
+    static F select(M m, F a, F b){ return _mm256_blendv_ps(b, a, m); }
+    
+    static M testBit(I buttons, uint32_t bit){
+        I flag = _mm256_set1_epi32(static_cast<int>(1u << bit));
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(buttons, flag), flag));
+    }
+    static I maskToInt(M m){ return _mm256_castps_si256(m); }
+    static I subi(I a, I b){ return _mm256_sub_epi32(a, b); }
+    static I andi(I a, uint32_t b){ return _mm256_and_si256(a, _mm256_set1_epi32(static_cast<int>(b))); }
+    static I ori(I a, I b){ return _mm256_or_si256(a, b); }
+};
+
+} // namespace
+
+std::size_t StepLanesAvx2(BatchArrays const& arrays, std::size_t count, float dt){
+    std::size_t done = count - count % Avx2Ops::WIDTH;
+    StepLanes<Avx2Ops>(arrays, 0, done, dt);
+    return done;
+}
+
+} // namespace batch_detail
+} // namespace pong
@@ -0,0 +1,190 @@
+#pragma once
+
+/*
+* Private to the batch simulator.
+*
+* The step is written once as a template over an `Ops` type that supplies the
+* vector type, comparisons and blends for one instruction set. Every branch of
+* pong::Step becomes a lane mask, and the results are merged with selects so
+* each register of matches is resolved without branching.
+*
+* Only templates live here, and it only includes headers without functions
+* (constants and the step's plain types): it is included by translation units
+* built with different instruction set flags, so any inline function reaching
+* it could have its AVX2 copy picked by the linker for the generic code path.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/constants.h"
+#include "core/step.h"
+
+namespace pong {
+namespace batch_detail {
+
+// Raw pointers into a BatchState, so kernels don't depend on std::vector
+struct BatchArrays{
+    float* ballX;
+    float* ballY;
+    float* ballVelocityX;
+    float* ballVelocityY;
+    float* paddleLeftY;
+    float* paddleRightY;
+    int32_t* leftScore;
+    int32_t* rightScore;
+    const uint32_t* buttons;
+    uint32_t* events;
+};
+
+template <class Ops>
+struct PaddleContact{
+    typename Ops::M hit;
+    typename Ops::F penetration;
+    typename Ops::M top;
+    typename Ops::M bottom;
+};
+
+// Vectorized CheckPaddleCollision: SAT overlap, penetration and zone for every lane
+template <class Ops>
+inline PaddleContact<Ops> CheckPaddleLanes(typename Ops::F ballX, typename Ops::F ballY, typename Ops::F velocityX,
+                                           typename Ops::F paddleX, typename Ops::F paddleY){
+    using F = typename Ops::F;
+    using M = typename Ops::M;
+    
+    F ballLeft = ballX;
+    F ballRight = Ops::add(ballX, Ops::set1(static_cast<float>(BALL_WIDTH)));
+    F ballTop = ballY;
+    F ballBottom = Ops::add(ballY, Ops::set1(static_cast<float>(BALL_HEIGHT)));
+    
+    F paddleLeft = paddleX;
+    F paddleRight = Ops::add(paddleX, Ops::set1(static_cast<float>(PADDLE_WIDTH)));
+    F paddleTop = paddleY;
+    F paddleBottom = Ops::add(paddleY, Ops::set1(static_cast<float>(PADDLE_HEIGHT)));
+    
+    // The projections overlap on both axes
+    M hit = Ops::and_(Ops::and_(Ops::lt(ballLeft, paddleRight), Ops::gt(ballRight, paddleLeft)),
+                      Ops::and_(Ops::lt(ballTop, paddleBottom), Ops::gt(ballBottom, paddleTop)));
+    
+    F zero = Ops::set1(0.0f);
+    F penetration = Ops::select(Ops::lt(velocityX, zero), Ops::sub(paddleRight, ballLeft),
+                    Ops::select(Ops::gt(velocityX, zero), Ops::sub(paddleLeft, ballRight), zero));
+    
+    // Top, middle and bottom thirds of the paddle
+    F paddleRangeUpper = Ops::sub(paddleBottom, Ops::set1(2.0f * PADDLE_HEIGHT / 3.0f));
+    F paddleRangeMiddle = Ops::sub(paddleBottom, Ops::set1(PADDLE_HEIGHT / 3.0f));
+    M top = Ops::and_(Ops::gt(ballBottom, paddleTop), Ops::lt(ballBottom, paddleRangeUpper));
+    M middle = Ops::and_(Ops::gt(ballBottom, paddleRangeUpper), Ops::lt(ballBottom, paddleRangeMiddle));
+    M bottom = Ops::andnot(Ops::or_(top, middle), Ops::set1mask());
+    
+    return PaddleContact<Ops>{hit, penetration, top, bottom};
+}
+
+// Vectorized paddle velocity from an up/down button pair
+template <class Ops>
+inline typename Ops::F PaddleVelocityLanes(typename Ops::I buttons, uint32_t upBit, uint32_t downBit){
+    return Ops::select(Ops::testBit(buttons, upBit), Ops::set1(-PADDLE_SPEED),
+           Ops::select(Ops::testBit(buttons, downBit), Ops::set1(PADDLE_SPEED), Ops::set1(0.0f)));
+}
+
+// Vectorized Paddle::update: move, then clamp to the window
+template <class Ops>
+inline typename Ops::F MovePaddleLanes(typename Ops::F y, typename Ops::F velocity, typename Ops::F dt){
+    using F = typename Ops::F;
+    
+    F zero = Ops::set1(0.0f);
+    F maxY = Ops::set1(static_cast<float>(WINDOW_HEIGHT - PADDLE_HEIGHT));
+    y = Ops::add(y, Ops::mul(velocity, dt));
+    return Ops::select(Ops::lt(y, zero), zero, Ops::select(Ops::gt(y, maxY), maxY, y));
+}
+
+/*
+* Steps matches [begin, end), `end - begin` must be a multiple of Ops::WIDTH
+*/
+template <class Ops>
+void StepLanes(BatchArrays const& a, std::size_t begin, std::size_t end, float dtScalar){
+    using F = typename Ops::F;
+    using M = typename Ops::M;
+    using I = typename Ops::I;
+    
+    const F dt = Ops::set1(dtScalar);
+    const F zero = Ops::set1(0.0f);
+    const F paddleLeftX = Ops::set1(50.0f);
+    const F paddleRightX = Ops::set1(WINDOW_WIDTH - 50.0f);
+    const F deflection = Ops::set1(0.75f * BALL_SPEED);
+    const F deflectionUp = Ops::set1(-.75f * BALL_SPEED);
+    
+    for(std::size_t i = begin; i < end; i += Ops::WIDTH){
+        I buttons = Ops::loadi(a.buttons + i);
+        
+        // Paddles
+        F leftVelocity = PaddleVelocityLanes<Ops>(buttons, Buttons::PaddleLeftUp, Buttons::PaddleLeftDown);
+        F rightVelocity = PaddleVelocityLanes<Ops>(buttons, Buttons::PaddleRightUp, Buttons::PaddleRightDown);
+        F paddleLeftY = MovePaddleLanes<Ops>(Ops::load(a.paddleLeftY + i), leftVelocity, dt);
+        F paddleRightY = MovePaddleLanes<Ops>(Ops::load(a.paddleRightY + i), rightVelocity, dt);
+        Ops::store(a.paddleLeftY + i, paddleLeftY);
+        Ops::store(a.paddleRightY + i, paddleRightY);
+        
+        // Ball
+        F velocityX = Ops::load(a.ballVelocityX + i);
+        F velocityY = Ops::load(a.ballVelocityY + i);
+        F ballX = Ops::add(Ops::load(a.ballX + i), Ops::mul(velocityX, dt));
+        F ballY = Ops::add(Ops::load(a.ballY + i), Ops::mul(velocityY, dt));
+        
+        // Left paddle wins over right paddle, either paddle wins over the walls
+        PaddleContact<Ops> left = CheckPaddleLanes<Ops>(ballX, ballY, velocityX, paddleLeftX, paddleLeftY);
+        PaddleContact<Ops> right = CheckPaddleLanes<Ops>(ballX, ballY, velocityX, paddleRightX, paddleRightY);
+        M paddleHit = Ops::or_(left.hit, right.hit);
+        F penetration = Ops::select(left.hit, left.penetration, right.penetration);
+        M top = Ops::and_(paddleHit, Ops::select(left.hit, left.top, right.top));
+        M bottom = Ops::and_(paddleHit, Ops::select(left.hit, left.bottom, right.bottom));
+        
+        // Vectorized CheckWallCollision, only for lanes without a paddle hit
+        F ballBottom = Ops::add(ballY, Ops::set1(static_cast<float>(BALL_HEIGHT)));
+        M wallLeft = Ops::andnot(paddleHit, Ops::lt(ballX, zero));
+        M wallRight = Ops::andnot(Ops::or_(paddleHit, wallLeft),
+                                  Ops::gt(Ops::add(ballX, Ops::set1(static_cast<float>(BALL_WIDTH))), Ops::set1(static_cast<float>(WINDOW_WIDTH))));
+        M scored = Ops::or_(wallLeft, wallRight);
+        M wallTop = Ops::andnot(Ops::or_(paddleHit, scored), Ops::lt(ballY, zero));
+        M wallBottom = Ops::andnot(Ops::or_(Ops::or_(paddleHit, scored), wallTop),
+                                   Ops::gt(ballBottom, Ops::set1(static_cast<float>(WINDOW_HEIGHT))));
+        M wallHit = Ops::or_(wallTop, wallBottom);
+        
+        // Resolve: Ball::CollideWithPaddle and Ball::CollideWithWall as blends
+        F newX = Ops::select(paddleHit, Ops::add(ballX, penetration),
+                 Ops::select(scored, Ops::set1(WINDOW_WIDTH / 2.0f), ballX));
+        F newY = Ops::select(scored, Ops::set1(WINDOW_HEIGHT / 2.0f),
+                 Ops::select(wallTop, Ops::add(ballY, Ops::neg(ballY)),
+                 Ops::select(wallBottom, Ops::add(ballY, Ops::sub(Ops::set1(static_cast<float>(WINDOW_HEIGHT)), ballBottom)), ballY)));
+        F newVelocityX = Ops::select(paddleHit, Ops::neg(velocityX),
+                         Ops::select(wallLeft, Ops::set1(BALL_SPEED),
+                         Ops::select(wallRight, Ops::set1(-BALL_SPEED), velocityX)));
+        F newVelocityY = Ops::select(top, deflectionUp,
+                         Ops::select(bottom, deflection,
+                         Ops::select(scored, deflection,
+                         Ops::select(wallHit, Ops::neg(velocityY), velocityY))));
+        
+        Ops::store(a.ballX + i, newX);
+        Ops::store(a.ballY + i, newY);
+        Ops::store(a.ballVelocityX + i, newVelocityX);
+        Ops::store(a.ballVelocityY + i, newVelocityY);
+        
+        // A set mask is -1 as an integer, so subtracting it counts the point
+        Ops::storei(a.rightScore + i, Ops::subi(Ops::loadi(a.rightScore + i), Ops::maskToInt(wallLeft)));
+        Ops::storei(a.leftScore + i, Ops::subi(Ops::loadi(a.leftScore + i), Ops::maskToInt(wallRight)));
+        
+        I events = Ops::ori(Ops::ori(Ops::andi(Ops::maskToInt(paddleHit), EVENT_PADDLE_HIT),
+                                     Ops::andi(Ops::maskToInt(wallHit), EVENT_WALL_HIT)),
+                            Ops::ori(Ops::andi(Ops::maskToInt(wallRight), EVENT_LEFT_SCORED),
+                                     Ops::andi(Ops::maskToInt(wallLeft), EVENT_RIGHT_SCORED)));
+        Ops::storei(a.events + i, events);
+    }
+}
+
+#ifdef PONG_HAVE_AVX2
+// Defined in batch_avx2.cpp, which is the only file compiled with AVX2 enabled
+std::size_t StepLanesAvx2(BatchArrays const& arrays, std::size_t count, float dt);
+#endif
+
+} // namespace batch_detail
+} // namespace pong
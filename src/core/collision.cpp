@@ -0,0 +1,214 @@
+#include "core/collision.h"
+
+#include <algorithm>
+
+#include "core/fixed.h"
+
+namespace pong {
+
+// Determine the type of collision based on the range of the paddle where the ball collided
+template<typename T>
+static CollisionType PaddleZone(T ballBottom, T paddleTop, T paddleHeight){
+    T paddleBottom = paddleTop + paddleHeight;
+    
+    // Calculate the range of the paddle where the ball collided    
+    T paddleRangeUpper = paddleBottom - (T(2) * paddleHeight / T(3));
+    T paddleRangeMiddle = paddleBottom - (paddleHeight / T(3));
+    
+    if((ballBottom > paddleTop) && (ballBottom < paddleRangeUpper)){
+        return CollisionType::Top;
+    }else if((ballBottom > paddleRangeUpper) && (ballBottom < paddleRangeMiddle)){
+        return CollisionType::Middle;
+    }
+    return CollisionType::Bottom;
+}
+
+template<typename T>
+BasicContact<T> CheckPaddleCollision(BasicBall<T> const& ball, BasicPaddle<T> const& paddle, T paddleHeight){
+    using C = Constants<T>;
+    T ballLeft = ball.position.x;
+    T ballRight = ball.position.x + C::ballWidth;
+    T ballTop = ball.position.y;
+    T ballBottom = ball.position.y + C::ballHeight;
+
+    T paddleLeft = paddle.position.x;
+    T paddleRight = paddle.position.x + C::paddleWidth;
+    T paddleTop = paddle.position.y;
+    T paddleBottom = paddle.position.y + paddleHeight;
+
+    BasicContact<T> contact{};
+    
+    // No collision if the ball is to the left, right, above, or below the paddle
+    if(ballLeft >= paddleRight)
+        return contact;
+
+    if( ballRight <= paddleLeft)
+        return contact;
+    
+    if(ballTop >= paddleBottom)
+        return contact;
+    
+    if(ballBottom <= paddleTop)
+        return contact;
+    
+    if(ball.velocity.x < T(0)){
+        // Left paddle collision
+        contact.penetration = paddleRight - ballLeft;
+    }else if(ball.velocity.x > T(0)){
+        // Right paddle collision
+        contact.penetration = paddleLeft - ballRight;
+    }
+  
+    contact.type = PaddleZone(ballBottom, paddleTop, paddleHeight);
+    
+    return contact;
+}
+
+template<typename T>
+BasicContact<T> CheckWallCollision(BasicBall<T> const& ball){
+    using C = Constants<T>;
+    T ballLeft = ball.position.x;
+    T ballRight = ball.position.x + C::ballWidth;
+    T ballTop = ball.position.y;
+    T ballBottom = ball.position.y + C::ballHeight;
+    
+    BasicContact<T> contact{};
+    
+    if(ballLeft < T(0)){
+        contact.type = CollisionType::Left;
+    }else if(ballRight > C::windowWidth){
+        contact.type = CollisionType::Right;
+    }else if(ballTop < T(0)){
+        contact.type = CollisionType::Top;
+        contact.penetration = -ballTop;
+    }else if(ballBottom > C::windowHeight){
+        contact.type = CollisionType::Bottom;
+        contact.penetration = C::windowHeight - ballBottom;
+    }
+    return contact;
+}
+
+/*
+* Entry and exit times of a moving interval [minA, maxA] against a fixed interval [minB, maxB] on one axis
+*   - A stationary interval either always overlaps (-inf, +inf) or never does (+inf, -inf)
+*/
+template<typename T>
+static void SweepAxis(T minA, T maxA, T velocity, T minB, T maxB, T& entry, T& exit){
+    const T infinity = Never<T>();
+    
+    if(velocity > T(0)){
+        entry = (minB - maxA) / velocity;
+        exit = (maxB - minA) / velocity;
+    }else if(velocity < T(0)){
+        entry = (maxB - minA) / velocity;
+        exit = (minB - maxA) / velocity;
+    }else if(maxA > minB && minA < maxB){
+        entry = -infinity;
+        exit = infinity;
+    }else{
+        entry = infinity;
+        exit = -infinity;
+    }
+}
+
+template<typename T>
+BasicSweptContact<T> SweepPaddleCollision(BasicBall<T> const& ball, BasicPaddle<T> const& paddle, T maxTime, T paddleHeight){
+    using C = Constants<T>;
+    T ballLeft = ball.position.x;
+    T ballRight = ball.position.x + C::ballWidth;
+    T ballTop = ball.position.y;
+    T ballBottom = ball.position.y + C::ballHeight;
+
+    T paddleLeft = paddle.position.x;
+    T paddleRight = paddle.position.x + C::paddleWidth;
+    T paddleTop = paddle.position.y;
+    T paddleBottom = paddle.position.y + paddleHeight;
+    
+    BasicSweptContact<T> swept{};
+    
+    T entryX, exitX, entryY, exitY;
+    SweepAxis(ballLeft, ballRight, ball.velocity.x, paddleLeft, paddleRight, entryX, exitX);
+    SweepAxis(ballTop, ballBottom, ball.velocity.y, paddleTop, paddleBottom, entryY, exitY);
+    
+    // The boxes touch once they overlap on both axes, and stop touching as soon as either axis separates
+    T entry = std::max(entryX, entryY);
+    T exit = std::min(exitX, exitY);
+    
+    /*
+    * Already overlapping at the start of the step, as when the paddle moved onto the ball:
+    * a contact at time 0, pushed out of the front face the way the discrete check does it
+    *   - Unless the ball is already moving away from the paddle, then it just leaves
+    */
+    if(entry < T(0) && exit > T(0)){
+        bool approaching = (paddleLeft + paddleRight > ballLeft + ballRight) ? ball.velocity.x > T(0) : ball.velocity.x < T(0);
+        if(!approaching)
+            return swept;
+        
+        swept.time = T(0);
+        swept.contact.type = PaddleZone(ballBottom, paddleTop, paddleHeight);
+        swept.contact.penetration = (ball.velocity.x < T(0)) ? paddleRight - ballLeft : paddleLeft - ballRight;
+        return swept;
+    }
+    
+    // No hit if the boxes never overlap or only meet after this step
+    if(entry >= exit || entry < T(0) || entry > maxTime)
+        return swept;
+    
+    swept.time = entry;
+    
+    if(entryX >= entryY){
+        // The ball reaches the front face last, so it hits the front face
+        swept.contact.type = PaddleZone(ballBottom + ball.velocity.y * entry, paddleTop, paddleHeight);
+    }else{
+        // The ball clips the top or bottom end of the paddle
+        swept.edge = true;
+        swept.contact.type = (ball.velocity.y > T(0)) ? CollisionType::Top : CollisionType::Bottom;
+    }
+    return swept;
+}
+
+template<typename T>
+BasicSweptContact<T> SweepWallCollision(BasicBall<T> const& ball, T maxTime){
+    using C = Constants<T>;
+    T ballLeft = ball.position.x;
+    T ballRight = ball.position.x + C::ballWidth;
+    T ballTop = ball.position.y;
+    T ballBottom = ball.position.y + C::ballHeight;
+    
+    BasicSweptContact<T> swept{};
+    swept.time = Never<T>();
+    
+    // Keep the earliest boundary the ball reaches within maxTime, a ball already past one reaches it at once
+    auto consider = [&](CollisionType type, T time){
+        time = std::max(time, T(0));
+        if(time <= maxTime && time < swept.time){
+            swept.contact.type = type;
+            swept.time = time;
+        }
+    };
+    
+    if(ball.velocity.x < T(0)){
+        consider(CollisionType::Left, -ballLeft / ball.velocity.x);
+    }else if(ball.velocity.x > T(0)){
+        consider(CollisionType::Right, (C::windowWidth - ballRight) / ball.velocity.x);
+    }
+    if(ball.velocity.y < T(0)){
+        consider(CollisionType::Top, -ballTop / ball.velocity.y);
+    }else if(ball.velocity.y > T(0)){
+        consider(CollisionType::Bottom, (C::windowHeight - ballBottom) / ball.velocity.y);
+    }
+    return swept;
+}
+
+// The scalar types the game is simulated in
+template BasicContact<float> CheckPaddleCollision(BasicBall<float> const&, BasicPaddle<float> const&, float);
+template BasicContact<float> CheckWallCollision(BasicBall<float> const&);
+template BasicSweptContact<float> SweepPaddleCollision(BasicBall<float> const&, BasicPaddle<float> const&, float, float);
+template BasicSweptContact<float> SweepWallCollision(BasicBall<float> const&, float);
+
+template BasicContact<Fixed> CheckPaddleCollision(BasicBall<Fixed> const&, BasicPaddle<Fixed> const&, Fixed);
+template BasicContact<Fixed> CheckWallCollision(BasicBall<Fixed> const&);
+template BasicSweptContact<Fixed> SweepPaddleCollision(BasicBall<Fixed> const&, BasicPaddle<Fixed> const&, Fixed, Fixed);
+template BasicSweptContact<Fixed> SweepWallCollision(BasicBall<Fixed> const&, Fixed);
+
+} // namespace pong
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/ball.h"
+#include "core/paddle.h"
+
+namespace pong {
+
+/* To detect a collision between the balls and the paddles,
+*  we’ll make use of something called the Separating Axis Theorem (SAT). 
+*       -The SAT says (in simplified terms) that if you can show that 
+*        the projections of two objects onto an axis have a gap, 
+*        then the objects are not colliding. 
+*/
+template<typename T>
+BasicContact<T> CheckPaddleCollision(BasicBall<T> const& ball, BasicPaddle<T> const& paddle, T paddleHeight = Constants<T>::paddleHeight);
+
+template<typename T>
+BasicContact<T> CheckWallCollision(BasicBall<T> const& ball);
+
+/*
+* Result of a swept test
+*   - time is when, in milliseconds from the ball's current position, the contact happens
+*   - For paddles, edge is set when the ball strikes the top or bottom end instead of the face
+*   - A swept contact is exact, so penetration is always 0
+*/
+template<typename T>
+struct BasicSweptContact{
+    BasicContact<T> contact;
+    T time;
+    bool edge;
+};
+
+using SweptContact = BasicSweptContact<float>;
+
+/*
+* Swept (continuous) versions of the checks above
+*   - Instead of testing for overlap at the end of a step they find the first time
+*     within [0, maxTime] at which the moving ball touches the paddle or a wall,
+*     so a fast ball can't pass through a paddle between two steps
+*   - The paddle is treated as stationary during the sweep; a ball that already overlaps
+*     it and moves towards it is a contact at time 0, pushed out like CheckPaddleCollision
+*   - contact.type is None when nothing is reached within maxTime
+*   - paddleHeight in both paddle checks is PADDLE_HEIGHT unless the rules change it
+*   - All of these are instantiated for float and Fixed
+*/
+template<typename T>
+BasicSweptContact<T> SweepPaddleCollision(BasicBall<T> const& ball, BasicPaddle<T> const& paddle, T maxTime,
+                                          T paddleHeight = Constants<T>::paddleHeight);
+
+template<typename T>
+BasicSweptContact<T> SweepWallCollision(BasicBall<T> const& ball, T maxTime);
+
+} // namespace pong
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace pong {
+
+constexpr int WINDOW_WIDTH = 1280;
+constexpr int WINDOW_HEIGHT = 720;
+constexpr int BALL_WIDTH = 15;
+constexpr int BALL_HEIGHT = 15;
+constexpr int PADDLE_WIDTH = 10;
+constexpr int PADDLE_HEIGHT = 100;
+constexpr float PADDLE_SPEED = 1.0f;
+constexpr float BALL_SPEED = 1.0f;
+
+// Vertical speed, as a fraction of BALL_SPEED, of a ball hit off the top or bottom third of a paddle
+constexpr float PADDLE_DEFLECTION = 0.75f;
+
+// Length of one fixed simulation step in milliseconds (240 Hz)
+constexpr float FIXED_DT = 1000.0f / 240.0f;
+
+/*
+* The constants above in the scalar type T the simulation runs in
+*   - Converted at compile time, so Constants<Fixed> holds the same bits on every machine
+*/
+template<typename T>
+struct Constants{
+    static constexpr T windowWidth = T(WINDOW_WIDTH);
+    static constexpr T windowHeight = T(WINDOW_HEIGHT);
+    static constexpr T ballWidth = T(BALL_WIDTH);
+    static constexpr T ballHeight = T(BALL_HEIGHT);
+    static constexpr T paddleWidth = T(PADDLE_WIDTH);
+    static constexpr T paddleHeight = T(PADDLE_HEIGHT);
+    static constexpr T paddleSpeed = T(PADDLE_SPEED);
+    static constexpr T ballSpeed = T(BALL_SPEED);
+    static constexpr T deflection = T(PADDLE_DEFLECTION);
+    static constexpr T fixedDt = T(FIXED_DT);
+};
+
+} // namespace pong
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+namespace pong {
+
+/*
+* Signed Q16.16 fixed-point number: 16 integer bits, 16 fraction bits in an int32_t
+*   - Every operation is integer arithmetic, so a simulation in Fixed gives the same
+*     bits on any compiler and CPU, which floats only promise within one build
+*   - Range is about +-32767 with a resolution of 1/65536, plenty for a 1280x720 field
+*   - Products and quotients are computed in 64 bits and rounded towards zero, a
+*     quotient that doesn't fit saturates instead of wrapping
+*   - The float constructor is constexpr, so rule constants convert at compile time
+*/
+class Fixed{
+    public:
+        static constexpr int FRACTION_BITS = 16;
+        static constexpr int32_t ONE = 1 << FRACTION_BITS;
+        
+        constexpr Fixed() : raw(0) {}
+        constexpr Fixed(int value) : raw(value * ONE) {}
+        constexpr explicit Fixed(float value)
+            : raw(static_cast<int32_t>(value * ONE + (value >= 0.0f ? 0.5f : -0.5f))) {}
+        
+        static constexpr Fixed FromRaw(int32_t raw){
+            Fixed value;
+            value.raw = raw;
+            return value;
+        }
+        
+        constexpr int32_t Raw() const { return raw; }
+        constexpr float ToFloat() const { return static_cast<float>(raw) / ONE; }
+        
+        constexpr Fixed operator-() const { return FromRaw(-raw); }
+        constexpr Fixed operator+(Fixed rhs) const { return FromRaw(raw + rhs.raw); }
+        constexpr Fixed operator-(Fixed rhs) const { return FromRaw(raw - rhs.raw); }
+        
+        constexpr Fixed operator*(Fixed rhs) const{
+            return FromRaw(static_cast<int32_t>(static_cast<int64_t>(raw) * rhs.raw / ONE));
+        }
+        
+        constexpr Fixed operator/(Fixed rhs) const{
+            int64_t quotient = static_cast<int64_t>(raw) * ONE / rhs.raw;
+            if(quotient > INT32_MAX){
+                return FromRaw(INT32_MAX);
+            }else if(quotient < -INT32_MAX){
+                return FromRaw(-INT32_MAX);
+            }
+            return FromRaw(static_cast<int32_t>(quotient));
+        }
+        
+        Fixed& operator+=(Fixed rhs){ raw += rhs.raw; return *this; }
+        Fixed& operator-=(Fixed rhs){ raw -= rhs.raw; return *this; }
+        
+        constexpr bool operator==(Fixed rhs) const { return raw == rhs.raw; }
+        constexpr bool operator!=(Fixed rhs) const { return raw != rhs.raw; }
+        constexpr bool operator<(Fixed rhs) const { return raw < rhs.raw; }
+        constexpr bool operator>(Fixed rhs) const { return raw > rhs.raw; }
+        constexpr bool operator<=(Fixed rhs) const { return raw <= rhs.raw; }
+        constexpr bool operator>=(Fixed rhs) const { return raw >= rhs.raw; }
+        
+    private:
+        int32_t raw;
+};
+
+/*
+* A value larger than any time or distance in the game, for "never" in the collision sweeps
+*   - Infinity for floats, the largest value for Fixed, which has no infinity
+*/
+template<typename T>
+constexpr T Never(){
+    return std::numeric_limits<T>::infinity();
+}
+
+template<>
+constexpr Fixed Never<Fixed>(){
+    return Fixed::FromRaw(INT32_MAX);
+}
+
+// Converts any scalar to float, for drawing and hashing
+inline float ToFloat(float value){ return value; }
+inline float ToFloat(Fixed value){ return value.ToFloat(); }
+
+} // namespace pong
@@ -0,0 +1,247 @@
+#include "core/game.h"
+
+#include "core/collision.h"
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+namespace pong {
+
+template<typename T>
+BasicGameState<T> NewGame(BasicRules<T> const& rules){
+    using C = Constants<T>;
+    using V = BasicVec2<T>;
+    const T half = T(0.5f);
+    
+    BasicGameState<T> state;
+    state.rules = rules;
+    state.ball = BasicBall<T>(V(C::windowWidth*half - C::ballWidth*half , C::windowHeight*half - C::ballHeight*half), V(rules.ballSpeed, T(0)));
+    state.paddleLeft = BasicPaddle<T>(V(T(50), C::windowHeight*half - rules.paddleHeight*half), V(T(0), T(0)));
+    state.paddleRight = BasicPaddle<T>(V(C::windowWidth - T(50), C::windowHeight*half - rules.paddleHeight*half), V(T(0), T(0)));
+    return state;
+}
+
+// Maps an up/down button pair to a paddle velocity
+template<typename T>
+static T PaddleVelocity(bool up, bool down, T speed){
+    if(up){
+        return -speed;
+    } else if(down){
+        return speed;
+    }
+    return T(0);
+}
+
+/*
+* Resolves whatever the ball overlaps after a discrete move
+*   - Paddles are checked before the walls, and only one contact is resolved per step
+*/
+template<typename T>
+static void ResolveDiscrete(BasicGameState<T>& state){
+    BasicRules<T> const& rules = state.rules;
+    
+    // If ball is colliding with the paddle, reverse the velocity of the ball
+    if(BasicContact<T> contact = CheckPaddleCollision(state.ball, state.paddleLeft, rules.paddleHeight); contact.type != CollisionType::None){
+        state.ball.CollideWithPaddle(contact, rules.ballSpeed);
+        state.events |= EVENT_PADDLE_HIT;
+    }else if(contact = CheckPaddleCollision(state.ball, state.paddleRight, rules.paddleHeight); contact.type != CollisionType::None){
+        state.ball.CollideWithPaddle(contact, rules.ballSpeed);
+        state.events |= EVENT_PADDLE_HIT;
+    }else if(contact = CheckWallCollision(state.ball); contact.type != CollisionType::None){
+        state.ball.CollideWithWall(contact, rules.ballSpeed);
+        
+        /*
+        * - If the ball collides with the left wall then the right player scores
+        * - If the ball collides with the right wall then the left player scores
+        */
+        if(contact.type == CollisionType::Left){
+            ++state.rightScore;
+            state.events |= EVENT_RIGHT_SCORED;
+        }else if(contact.type == CollisionType::Right){
+            ++state.leftScore;
+            state.events |= EVENT_LEFT_SCORED;
+        }else{
+            state.events |= EVENT_WALL_HIT;
+        }
+    }
+}
+
+/*
+* Moves the ball from contact to contact until the step's time is used up
+*   - Each iteration finds the earliest paddle or wall the ball reaches in the remaining
+*     time, moves the ball exactly there and bounces it, so a paddle and then a wall
+*     (a corner) can both be hit within one step
+*   - On ties the left paddle wins over the right paddle, and either paddle over the walls
+*   - A goal resets the ball and ends its movement for this step
+*   - The paddle hit last is skipped on the next iteration, since the ball is still touching it
+*/
+template<typename T>
+static void MoveBallSwept(BasicGameState<T>& state, T dt){
+    BasicBall<T>& ball = state.ball;
+    BasicRules<T> const& rules = state.rules;
+    ball.previousPosition = ball.position;
+    
+    BasicPaddle<T> const* lastPaddle = nullptr;
+    T remaining = dt;
+    
+    for(int bounce = 0; bounce < MAX_SWEPT_BOUNCES && remaining > T(0); ++bounce){
+        BasicSweptContact<T> hit{};
+        BasicPaddle<T> const* hitPaddle = nullptr;
+        
+        for(BasicPaddle<T> const* paddle : {&state.paddleLeft, &state.paddleRight}){
+            if(paddle == lastPaddle)
+                continue;
+            
+            BasicSweptContact<T> swept = SweepPaddleCollision(ball, *paddle, remaining, rules.paddleHeight);
+            if(swept.contact.type != CollisionType::None && (hitPaddle == nullptr || swept.time < hit.time)){
+                hit = swept;
+                hitPaddle = paddle;
+            }
+        }
+        
+        BasicSweptContact<T> wall = SweepWallCollision(ball, remaining);
+        if(wall.contact.type != CollisionType::None && (hitPaddle == nullptr || wall.time < hit.time)){
+            hit = wall;
+            hitPaddle = nullptr;
+        }
+        
+        // Nothing in the way, use up the rest of the step
+        if(hit.contact.type == CollisionType::None){
+            ball.position += ball.velocity * remaining;
+            break;
+        }
+        
+        ball.position += ball.velocity * hit.time;
+        remaining -= hit.time;
+        lastPaddle = hitPaddle;
+        
+        if(hitPaddle != nullptr){
+            if(hit.edge){
+                ball.velocity.y = -ball.velocity.y;
+            }else{
+                ball.CollideWithPaddle(hit.contact, rules.ballSpeed);
+            }
+            state.events |= EVENT_PADDLE_HIT;
+            continue;
+        }
+        
+        ball.CollideWithWall(hit.contact, rules.ballSpeed);
+        
+        if(hit.contact.type == CollisionType::Left){
+            ++state.rightScore;
+            state.events |= EVENT_RIGHT_SCORED;
+            break;
+        }else if(hit.contact.type == CollisionType::Right){
+            ++state.leftScore;
+            state.events |= EVENT_LEFT_SCORED;
+            break;
+        }
+        state.events |= EVENT_WALL_HIT;
+    }
+}
+
+template<typename T>
+void UpdatePaddles(BasicGameState<T>& state, Inputs const& inputs, T dt){
+    /*
+    * Adjust the paddle speed according to the button pressed
+    *   - If the up button is pressed, it's velocity is set to -paddleSpeed
+    *   - If the down button is pressed, it's velocity is set to paddleSpeed
+    *   - If no button is pressed, it's velocity is set to 0
+    */
+    BasicRules<T> const& rules = state.rules;
+    state.paddleLeft.velocity.y = PaddleVelocity(inputs.buttons[Buttons::PaddleLeftUp], inputs.buttons[Buttons::PaddleLeftDown], rules.paddleSpeed);
+    state.paddleRight.velocity.y = PaddleVelocity(inputs.buttons[Buttons::PaddleRightUp], inputs.buttons[Buttons::PaddleRightDown], rules.paddleSpeed);
+    
+    // Update the paddle positions
+    state.paddleRight.update(dt, rules.paddleHeight);
+    state.paddleLeft.update(dt, rules.paddleHeight);
+}
+
+void UpdatePaddlesTimed(GameState& state, Inputs& inputs, InputEvent const* events, int eventCount, float dt){
+    Vec2 leftStart = state.paddleLeft.position;
+    Vec2 rightStart = state.paddleRight.position;
+    
+    // Move through the step one stretch of constant buttons at a time
+    float time = 0.0f;
+    for(int i = 0; i <= eventCount; ++i){
+        float until = (i < eventCount) ? std::min(std::max(events[i].time, time), dt) : dt;
+        if(until > time || i == eventCount){
+            UpdatePaddles(state, inputs, until - time);
+            time = until;
+        }
+        if(i < eventCount){
+            inputs.buttons[events[i].button] = events[i].pressed;
+        }
+    }
+    
+    // Interpolation runs from where the paddles were before the whole step
+    state.paddleLeft.previousPosition = leftStart;
+    state.paddleRight.previousPosition = rightStart;
+}
+
+template<typename T>
+void UpdateBall(BasicGameState<T>& state, T dt, CollisionMode mode){
+    if(mode == CollisionMode::Swept){
+        MoveBallSwept(state, dt);
+    }else{
+        // Update the ball position
+        state.ball.update(dt);
+    }
+}
+
+template<typename T>
+void ResolveCollisions(BasicGameState<T>& state, CollisionMode mode){
+    // A swept move has already resolved its contacts
+    if(mode == CollisionMode::Discrete){
+        ResolveDiscrete(state);
+    }
+}
+
+template<typename T>
+BasicGameState<T> Step(BasicGameState<T> state, Inputs const& inputs, T dt, CollisionMode mode){
+    state.events = EVENT_NONE;
+    
+    UpdatePaddles(state, inputs, dt);
+    UpdateBall(state, dt, mode);
+    ResolveCollisions(state, mode);
+    
+    return state;
+}
+
+template<typename T>
+static Vec2 ToFloat(BasicVec2<T> const& vector){
+    return Vec2(ToFloat(vector.x), ToFloat(vector.y));
+}
+
+GameState ToFloat(FixedGameState const& state){
+    GameState converted;
+    converted.ball.position = ToFloat(state.ball.position);
+    converted.ball.previousPosition = ToFloat(state.ball.previousPosition);
+    converted.ball.velocity = ToFloat(state.ball.velocity);
+    for(auto paddle : {std::make_pair(&converted.paddleLeft, &state.paddleLeft), std::make_pair(&converted.paddleRight, &state.paddleRight)}){
+        paddle.first->position = ToFloat(paddle.second->position);
+        paddle.first->previousPosition = ToFloat(paddle.second->previousPosition);
+        paddle.first->velocity = ToFloat(paddle.second->velocity);
+    }
+    converted.leftScore = state.leftScore;
+    converted.rightScore = state.rightScore;
+    converted.events = state.events;
+    converted.rules = Rules{ToFloat(state.rules.ballSpeed), ToFloat(state.rules.paddleSpeed), ToFloat(state.rules.paddleHeight)};
+    return converted;
+}
+
+// The scalar types the game is simulated in
+template GameState NewGame(Rules const&);
+template GameState Step(GameState, Inputs const&, float, CollisionMode);
+template void UpdatePaddles(GameState&, Inputs const&, float);
+template void UpdateBall(GameState&, float, CollisionMode);
+template void ResolveCollisions(GameState&, CollisionMode);
+
+template FixedGameState NewGame(BasicRules<Fixed> const&);
+template FixedGameState Step(FixedGameState, Inputs const&, Fixed, CollisionMode);
+template void UpdatePaddles(FixedGameState&, Inputs const&, Fixed);
+template void UpdateBall(FixedGameState&, Fixed, CollisionMode);
+template void ResolveCollisions(FixedGameState&, CollisionMode);
+
+} // namespace pong
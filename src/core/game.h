@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/ball.h"
+#include "core/fixed.h"
+#include "core/paddle.h"
+#include "core/step.h"
+
+namespace pong {
+
+/*
+* How the ball is tested against the paddles and walls
+*   - Discrete moves the ball by a whole step and then checks for overlap, like the original game
+*   - Swept finds the exact time of impact within the step and resolves up to
+*     MAX_SWEPT_BOUNCES contacts in order, so large steps and fast balls can't tunnel
+*/
+enum class CollisionMode{
+    Discrete,
+    Swept
+};
+
+const int MAX_SWEPT_BOUNCES = 8;
+
+/*
+* The constants of a match that can be tuned without rebuilding
+*   - The defaults are the game's own, replays, netplay and the frontend always use them
+*   - pong_tournament sweeps them to balance the game
+*   - The batch kernels and arena mode only support the defaults
+*/
+template<typename T>
+struct BasicRules{
+    T ballSpeed = Constants<T>::ballSpeed;
+    T paddleSpeed = Constants<T>::paddleSpeed;
+    T paddleHeight = Constants<T>::paddleHeight;
+};
+
+/*
+* Everything needed to simulate a match, with no dependency on SDL
+*   - Copyable by value, so a state can be saved, compared or replayed freely
+*   - T is the scalar type: float, or Fixed for results that are bit-exact on every
+*     compiler and CPU instead of only within one build
+*/
+template<typename T>
+struct BasicGameState{
+    BasicBall<T> ball;
+    BasicPaddle<T> paddleLeft;
+    BasicPaddle<T> paddleRight;
+    int leftScore = 0;
+    int rightScore = 0;
+    unsigned events = EVENT_NONE;
+    BasicRules<T> rules;
+};
+
+using Rules = BasicRules<float>;
+using GameState = BasicGameState<float>;
+using FixedGameState = BasicGameState<Fixed>;
+
+/*
+* Returns the state of a fresh match
+*   - The ball starts in the center of the field moving to the right,
+*     half of its width and height are subtracted because positions
+*     refer to the upper left corner
+*   - The paddles start vertically centered, 50 px from either side
+*/
+template<typename T = float>
+BasicGameState<T> NewGame(BasicRules<T> const& rules = BasicRules<T>{});
+
+// Advances `state` by `dt` milliseconds with the given inputs held
+template<typename T>
+BasicGameState<T> Step(BasicGameState<T> state, Inputs const& inputs, T dt, CollisionMode mode = CollisionMode::Discrete);
+
+/*
+* The phases of Step(), in order, for callers that want to time them separately
+*   - Clear state.events before the first one, exactly as Step() does
+*   - In Swept mode UpdateBall() also resolves the contacts and ResolveCollisions() does nothing
+*   - These and the two above are instantiated for float and Fixed
+*/
+template<typename T>
+void UpdatePaddles(BasicGameState<T>& state, Inputs const& inputs, T dt);
+template<typename T>
+void UpdateBall(BasicGameState<T>& state, T dt, CollisionMode mode = CollisionMode::Discrete);
+template<typename T>
+void ResolveCollisions(BasicGameState<T>& state, CollisionMode mode = CollisionMode::Discrete);
+
+/*
+* UpdatePaddles() with the buttons changing during the step
+*   - `inputs` holds the buttons at the start of the step and is left holding them at the end
+*   - Each paddle moves at the speed its buttons give it between one event and the next,
+*     so a press late in the step moves it less and a tap shorter than the step still
+*     moves it for as long as it was held
+*   - `events` must be sorted by time, with no events it is exactly UpdatePaddles()
+*/
+void UpdatePaddlesTimed(GameState& state, Inputs& inputs, InputEvent const* events, int eventCount, float dt);
+
+// A fixed-point match as floats, for drawing it and driving PaddleAi
+GameState ToFloat(FixedGameState const& state);
+
+} // namespace pong
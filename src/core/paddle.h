@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/constants.h"
+#include "core/vec2.h"
+
+namespace pong {
+
+// A paddle, in scalar type T (float or Fixed)
+template<typename T>
+class BasicPaddle{
+    public:
+        using C = Constants<T>;
+        
+        BasicVec2<T> position;
+        BasicVec2<T> previousPosition;
+        BasicVec2<T> velocity;
+        
+        BasicPaddle() = default;
+        BasicPaddle(BasicVec2<T> position, BasicVec2<T> velocity) :  position(position), previousPosition(position), velocity(velocity){}
+        
+        // `height` is the paddle's height, PADDLE_HEIGHT unless the rules change it
+        void update(T dt, T height = C::paddleHeight){
+            previousPosition = position;
+            
+            // Update the position of the paddle
+            position += velocity * dt;
+            
+            if(position.y < T(0)){
+                
+                // If paddle is on the top of the window, set it to 0
+                position.y = T(0);
+            }else if(position.y > (C::windowHeight - height)){
+                
+                // If paddle is on the bottom of the window, set it to the bottom
+                position.y = C::windowHeight - height;
+            }
+        }
+};
+
+using Paddle = BasicPaddle<float>;
+
+} // namespace pong
@@ -0,0 +1,380 @@
+#include "core/replay.h"
+
+#include <cstring>
+
+namespace pong {
+
+static const char REPLAY_MAGIC[8] = {'P', 'O', 'N', 'G', 'R', 'P', 'L', '1'};
+static const uint8_t END_OF_RECORDS = 0xFF;
+
+// Set in the stored collision mode for a match simulated in Fixed, older logs never have it
+static const uint32_t FIXED_POINT_FLAG = 1u << 8;
+
+// The file is read and written through buffers this large
+static const std::size_t REPLAY_BUFFER_SIZE = 1 << 16;
+
+/*
+* Little-endian encoding helpers, so logs are portable between machines
+*/
+static void WriteU32(std::FILE* file, uint32_t value){
+    uint8_t bytes[4];
+    for(int i = 0; i < 4; ++i){
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    std::fwrite(bytes, 1, 4, file);
+}
+
+static void WriteU64(std::FILE* file, uint64_t value){
+    WriteU32(file, static_cast<uint32_t>(value));
+    WriteU32(file, static_cast<uint32_t>(value >> 32));
+}
+
+static void WriteF32(std::FILE* file, float value){
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteU32(file, bits);
+}
+
+static void WriteVarint(std::FILE* file, uint64_t value){
+    while(value >= 0x80){
+        std::fputc(static_cast<int>((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+    std::fputc(static_cast<int>(value), file);
+}
+
+static bool ReadU32(std::FILE* file, uint32_t& value){
+    uint8_t bytes[4];
+    if(std::fread(bytes, 1, 4, file) != 4){
+        return false;
+    }
+    value = 0;
+    for(int i = 0; i < 4; ++i){
+        value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    }
+    return true;
+}
+
+static bool ReadU64(std::FILE* file, uint64_t& value){
+    uint32_t low, high;
+    if(!ReadU32(file, low) || !ReadU32(file, high)){
+        return false;
+    }
+    value = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+}
+
+static bool ReadI32(std::FILE* file, int32_t& value){
+    uint32_t bits;
+    if(!ReadU32(file, bits)){
+        return false;
+    }
+    value = static_cast<int32_t>(bits);
+    return true;
+}
+
+static bool ReadF32(std::FILE* file, float& value){
+    uint32_t bits;
+    if(!ReadU32(file, bits)){
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+static bool ReadVarint(std::FILE* file, uint64_t& value){
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7){
+        int byte = std::fgetc(file);
+        if(byte == EOF){
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)){
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t HashBytes(uint64_t hash, const void* data, std::size_t size){
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for(std::size_t i = 0; i < size; ++i){
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t HashState(GameState const& state){
+    uint64_t hash = 0xcbf29ce484222325ull;
+    
+    // Hash field by field so padding bytes never take part
+    float values[] = {
+        state.ball.position.x, state.ball.position.y, state.ball.velocity.x, state.ball.velocity.y,
+        state.paddleLeft.position.x, state.paddleLeft.position.y, state.paddleLeft.velocity.y,
+        state.paddleRight.position.x, state.paddleRight.position.y, state.paddleRight.velocity.y
+    };
+    for(float value : values){
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        hash = HashBytes(hash, &bits, sizeof(bits));
+    }
+    int32_t scores[] = {state.leftScore, state.rightScore};
+    return HashBytes(hash, scores, sizeof(scores));
+}
+
+uint64_t HashState(FixedGameState const& state){
+    uint64_t hash = 0xcbf29ce484222325ull;
+    
+    // The raw values, in the same order as for floats
+    Fixed values[] = {
+        state.ball.position.x, state.ball.position.y, state.ball.velocity.x, state.ball.velocity.y,
+        state.paddleLeft.position.x, state.paddleLeft.position.y, state.paddleLeft.velocity.y,
+        state.paddleRight.position.x, state.paddleRight.position.y, state.paddleRight.velocity.y
+    };
+    for(Fixed value : values){
+        uint32_t bits = static_cast<uint32_t>(value.Raw());
+        hash = HashBytes(hash, &bits, sizeof(bits));
+    }
+    int32_t scores[] = {state.leftScore, state.rightScore};
+    return HashBytes(hash, scores, sizeof(scores));
+}
+
+bool SameRules(ReplayHeader const& header){
+    ReplayHeader current;
+    return header.fixedDt == current.fixedDt &&
+           header.ballSpeed == current.ballSpeed &&
+           header.paddleSpeed == current.paddleSpeed &&
+           header.windowWidth == current.windowWidth &&
+           header.windowHeight == current.windowHeight &&
+           header.ballWidth == current.ballWidth &&
+           header.ballHeight == current.ballHeight &&
+           header.paddleWidth == current.paddleWidth &&
+           header.paddleHeight == current.paddleHeight;
+}
+
+ReplayWriter::~ReplayWriter(){
+    if(file){
+        std::fclose(file);
+    }
+}
+
+bool ReplayWriter::Open(const char* path, ReplayHeader const& header){
+    file = std::fopen(path, "wb");
+    if(!file){
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, REPLAY_BUFFER_SIZE);
+    
+    std::fwrite(REPLAY_MAGIC, 1, sizeof(REPLAY_MAGIC), file);
+    WriteU64(file, header.seed);
+    WriteU32(file, static_cast<uint32_t>(header.mode) | (header.fixedPoint ? FIXED_POINT_FLAG : 0u));
+    WriteF32(file, header.fixedDt);
+    WriteF32(file, header.ballSpeed);
+    WriteF32(file, header.paddleSpeed);
+    WriteU32(file, static_cast<uint32_t>(header.windowWidth));
+    WriteU32(file, static_cast<uint32_t>(header.windowHeight));
+    WriteU32(file, static_cast<uint32_t>(header.ballWidth));
+    WriteU32(file, static_cast<uint32_t>(header.ballHeight));
+    WriteU32(file, static_cast<uint32_t>(header.paddleWidth));
+    WriteU32(file, static_cast<uint32_t>(header.paddleHeight));
+    return true;
+}
+
+static uint8_t ButtonMask(Inputs const& inputs){
+    uint8_t mask = 0;
+    for(int i = 0; i < 4; ++i){
+        if(inputs.buttons[i]){
+            mask |= static_cast<uint8_t>(1u << i);
+        }
+    }
+    return mask;
+}
+
+void ReplayWriter::FlushRun(){
+    if(runLength > 0){
+        std::fputc(runButtons, file);
+        WriteVarint(file, runLength);
+    }
+    runLength = 0;
+}
+
+void ReplayWriter::Record(Inputs const& inputs){
+    if(!file){
+        return;
+    }
+    
+    uint8_t buttons = ButtonMask(inputs);
+    if(runLength > 0 && buttons != runButtons){
+        FlushRun();
+    }
+    runButtons = buttons;
+    ++runLength;
+    ++steps;
+}
+
+bool ReplayWriter::Finish(GameState const& final){
+    return WriteFooter(final.leftScore, final.rightScore, HashState(final));
+}
+
+bool ReplayWriter::Finish(FixedGameState const& final){
+    return WriteFooter(final.leftScore, final.rightScore, HashState(final));
+}
+
+bool ReplayWriter::WriteFooter(int32_t leftScore, int32_t rightScore, uint64_t hash){
+    if(!file){
+        return false;
+    }
+    
+    FlushRun();
+    std::fputc(END_OF_RECORDS, file);
+    WriteU64(file, steps);
+    WriteU32(file, static_cast<uint32_t>(leftScore));
+    WriteU32(file, static_cast<uint32_t>(rightScore));
+    WriteU64(file, hash);
+    
+    bool ok = std::fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
+
+ReplayReader::~ReplayReader(){
+    if(file){
+        std::fclose(file);
+    }
+}
+
+bool ReplayReader::Open(const char* path){
+    file = std::fopen(path, "rb");
+    if(!file){
+        error = "can't open file";
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, REPLAY_BUFFER_SIZE);
+    
+    char magic[sizeof(REPLAY_MAGIC)];
+    if(std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0){
+        error = "not a replay file";
+        return false;
+    }
+    
+    uint32_t mode = 0;
+    bool ok = ReadU64(file, header.seed) &&
+              ReadU32(file, mode) &&
+              ReadF32(file, header.fixedDt) &&
+              ReadF32(file, header.ballSpeed) &&
+              ReadF32(file, header.paddleSpeed) &&
+              ReadI32(file, header.windowWidth) &&
+              ReadI32(file, header.windowHeight) &&
+              ReadI32(file, header.ballWidth) &&
+              ReadI32(file, header.ballHeight) &&
+              ReadI32(file, header.paddleWidth) &&
+              ReadI32(file, header.paddleHeight);
+    if(!ok){
+        error = "truncated or corrupt header";
+        return false;
+    }
+    header.fixedPoint = (mode & FIXED_POINT_FLAG) != 0;
+    mode &= ~FIXED_POINT_FLAG;
+    if(mode > static_cast<uint32_t>(CollisionMode::Swept)){
+        error = "truncated or corrupt header";
+        return false;
+    }
+    header.mode = static_cast<CollisionMode>(mode);
+    return true;
+}
+
+bool ReplayReader::Next(Inputs& inputs){
+    if(!file || finished){
+        return false;
+    }
+    
+    // Start the next run of equal inputs, or read the footer at the end
+    while(runRemaining == 0){
+        int buttons = std::fgetc(file);
+        if(buttons == END_OF_RECORDS){
+            bool ok = ReadU64(file, footer.steps) &&
+                      ReadI32(file, footer.leftScore) &&
+                      ReadI32(file, footer.rightScore) &&
+                      ReadU64(file, footer.hash);
+            if(!ok){
+                error = "truncated footer";
+            }
+            finished = true;
+            return false;
+        }
+        if(buttons == EOF || buttons > 0x0F || !ReadVarint(file, runRemaining)){
+            error = "truncated or corrupt input records";
+            finished = true;
+            return false;
+        }
+        runButtons = static_cast<uint8_t>(buttons);
+    }
+    
+    for(int i = 0; i < 4; ++i){
+        inputs.buttons[i] = (runButtons >> i) & 1u;
+    }
+    --runRemaining;
+    return true;
+}
+
+// Steps a match in scalar type T through the whole log, true unless the log is broken
+template<typename T>
+static bool ReplayAll(ReplayReader& reader, BasicGameState<T>& state, uint64_t& steps){
+    Inputs inputs;
+    while(reader.Next(inputs)){
+        state = Step(state, inputs, Constants<T>::fixedDt, reader.Header().mode);
+        ++steps;
+    }
+    return reader.Error() == nullptr;
+}
+
+ReplayResult RunReplay(const char* path){
+    ReplayResult result;
+    
+    ReplayReader reader;
+    if(!reader.Open(path)){
+        result.error = reader.Error();
+        return result;
+    }
+    if(!SameRules(reader.Header())){
+        result.error = "recorded with different rule constants";
+        return result;
+    }
+    
+    // A fixed-point log is replayed in fixed point, and reproduces on any machine
+    uint64_t hash;
+    bool ok;
+    if(reader.Header().fixedPoint){
+        FixedGameState state = NewGame<Fixed>();
+        ok = ReplayAll(reader, state, result.steps);
+        result.final = ToFloat(state);
+        hash = HashState(state);
+    }else{
+        GameState state = NewGame();
+        ok = ReplayAll(reader, state, result.steps);
+        result.final = state;
+        hash = HashState(state);
+    }
+    
+    if(!ok){
+        result.error = reader.Error();
+        return result;
+    }
+    
+    GameState const& state = result.final;
+    result.expected = reader.Footer();
+    if(result.steps != result.expected.steps){
+        result.error = "step count differs from the recording";
+    }else if(state.leftScore != result.expected.leftScore || state.rightScore != result.expected.rightScore){
+        result.error = "final score differs from the recording";
+    }else if(hash != result.expected.hash){
+        result.error = "final state hash differs from the recording";
+    }else{
+        result.ok = true;
+    }
+    return result;
+}
+
+} // namespace pong
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* Binary input log of a match
+*
+*   header   "PONGRPL1", then the rule constants the match was played with,
+*            the collision mode and the computer players' seed (all little-endian);
+*            bit 8 of the collision mode is set when the match was simulated in fixed point
+*   records  one byte holding the buttons as a bit mask (bit n is pong::Buttons n),
+*            followed by how many consecutive steps they were held as a varint
+*   end      the byte 0xFF
+*   footer   step count, final left and right score and HashState() of the final state
+*
+* Held buttons rarely change between 240 Hz steps, so a long match is a few
+* kilobytes. Every step is FIXED_DT long; replaying the records from NewGame()
+* must reproduce the footer exactly.
+*/
+struct ReplayHeader{
+    /*
+    * The AiSettings seed the computer players were started with (the right paddle's is
+    * derived from it), 0 if nobody played the computer. The match itself has no other randomness, and the records already hold
+    * the buttons the computer pressed, so replaying doesn't need it; it tells which
+    * opponent a match was played against
+    */
+    uint64_t seed = 0;
+    CollisionMode mode = CollisionMode::Discrete;
+    bool fixedPoint = false;
+    float fixedDt = FIXED_DT;
+    float ballSpeed = BALL_SPEED;
+    float paddleSpeed = PADDLE_SPEED;
+    int32_t windowWidth = WINDOW_WIDTH;
+    int32_t windowHeight = WINDOW_HEIGHT;
+    int32_t ballWidth = BALL_WIDTH;
+    int32_t ballHeight = BALL_HEIGHT;
+    int32_t paddleWidth = PADDLE_WIDTH;
+    int32_t paddleHeight = PADDLE_HEIGHT;
+};
+
+struct ReplayFooter{
+    uint64_t steps = 0;
+    int32_t leftScore = 0;
+    int32_t rightScore = 0;
+    uint64_t hash = 0;
+};
+
+// FNV-1a over the exact bits of the ball, the paddles and the scores
+uint64_t HashState(GameState const& state);
+uint64_t HashState(FixedGameState const& state);
+
+// Whether a log was recorded with the rules this build simulates
+bool SameRules(ReplayHeader const& header);
+
+/*
+* Writes a log while a match is played
+*   - Record() is called once per simulation step, runs of equal inputs are merged
+*     so only changes reach the file
+*/
+class ReplayWriter{
+    public:
+        ReplayWriter() = default;
+        ~ReplayWriter();
+        
+        ReplayWriter(ReplayWriter const&) = delete;
+        ReplayWriter& operator=(ReplayWriter const&) = delete;
+        
+        bool Open(const char* path, ReplayHeader const& header);
+        void Record(Inputs const& inputs);
+        
+        // Writes the end marker and the footer for `final` and closes the file
+        bool Finish(GameState const& final);
+        bool Finish(FixedGameState const& final);
+        
+        bool IsOpen() const { return file != nullptr; }
+        
+    private:
+        void FlushRun();
+        bool WriteFooter(int32_t leftScore, int32_t rightScore, uint64_t hash);
+        
+        std::FILE* file = nullptr;
+        uint8_t runButtons = 0;
+        uint64_t runLength = 0;
+        uint64_t steps = 0;
+};
+
+/*
+* Reads a log back one step at a time
+*   - The file is streamed through a fixed buffer, never loaded whole, so logs of
+*     any length replay in constant memory
+*/
+class ReplayReader{
+    public:
+        ReplayReader() = default;
+        ~ReplayReader();
+        
+        ReplayReader(ReplayReader const&) = delete;
+        ReplayReader& operator=(ReplayReader const&) = delete;
+        
+        bool Open(const char* path);
+        
+        // Inputs for the next step, false once the log is exhausted (or broken, see Error())
+        bool Next(Inputs& inputs);
+        
+        ReplayHeader const& Header() const { return header; }
+        
+        // Valid once Next() has returned false without an error
+        ReplayFooter const& Footer() const { return footer; }
+        
+        const char* Error() const { return error.empty() ? nullptr : error.c_str(); }
+        
+    private:
+        std::FILE* file = nullptr;
+        ReplayHeader header;
+        ReplayFooter footer;
+        uint8_t runButtons = 0;
+        uint64_t runRemaining = 0;
+        bool finished = false;
+        std::string error;
+};
+
+// Outcome of replaying a log
+struct ReplayResult{
+    bool ok = false;
+    uint64_t steps = 0;
+    GameState final;
+    ReplayFooter expected;
+    std::string error;
+};
+
+// Replays the whole log as fast as possible and checks the result against its footer
+ReplayResult RunReplay(const char* path);
+
+} // namespace pong
@@ -0,0 +1,118 @@
+#include "core/rollback.h"
+
+namespace pong {
+
+Inputs CombineInputs(PlayerInput left, PlayerInput right){
+    Inputs inputs;
+    inputs.buttons[Buttons::PaddleLeftUp] = left & 1u;
+    inputs.buttons[Buttons::PaddleLeftDown] = (left >> 1) & 1u;
+    inputs.buttons[Buttons::PaddleRightUp] = right & 1u;
+    inputs.buttons[Buttons::PaddleRightDown] = (right >> 1) & 1u;
+    return inputs;
+}
+
+PlayerInput PlayerInputFrom(Inputs const& inputs, int player){
+    bool up = inputs.buttons[player == 0 ? Buttons::PaddleLeftUp : Buttons::PaddleRightUp];
+    bool down = inputs.buttons[player == 0 ? Buttons::PaddleLeftDown : Buttons::PaddleRightDown];
+    return static_cast<PlayerInput>((up ? 1u : 0u) | (down ? 2u : 0u));
+}
+
+RollbackSession::RollbackSession(int localPlayer, GameState initial, CollisionMode mode)
+    : localPlayer(localPlayer), mode(mode), state(initial){
+}
+
+PlayerInput RollbackSession::RemoteFor(uint32_t step) const{
+    RemoteSlot const& slot = remote[step % (2 * ROLLBACK_WINDOW)];
+    if(slot.frame == step){
+        return slot.input;
+    }
+    
+    // Predict that the remote player still holds what they held last
+    if(confirmedFrame > 0){
+        return remote[(confirmedFrame - 1) % (2 * ROLLBACK_WINDOW)].input;
+    }
+    return 0;
+}
+
+void RollbackSession::AddRemoteInput(uint32_t step, PlayerInput input){
+    // Already confirmed, or too far ahead to keep
+    if(step < confirmedFrame || step >= confirmedFrame + 2 * ROLLBACK_WINDOW){
+        return;
+    }
+    
+    RemoteSlot& slot = remote[step % (2 * ROLLBACK_WINDOW)];
+    if(slot.frame == step){
+        return;
+    }
+    slot.frame = step;
+    slot.input = input;
+    
+    while(remote[confirmedFrame % (2 * ROLLBACK_WINDOW)].frame == confirmedFrame){
+        ++confirmedFrame;
+    }
+    
+    // A step already simulated with a different guess has to be redone
+    FrameSlot const& simulated = slots[step % ROLLBACK_WINDOW];
+    if(step < frame && simulated.frame == step && simulated.remoteUsed != input && step < pendingRollback){
+        pendingRollback = step;
+    }
+}
+
+void RollbackSession::Simulate(FrameSlot& slot){
+    slot.before = state;
+    slot.remoteUsed = RemoteFor(slot.frame);
+    
+    PlayerInput left = (localPlayer == 0) ? slot.local : slot.remoteUsed;
+    PlayerInput right = (localPlayer == 0) ? slot.remoteUsed : slot.local;
+    state = Step(state, CombineInputs(left, right), FIXED_DT, mode);
+    slot.events = state.events;
+}
+
+void RollbackSession::Resolve(){
+    if(pendingRollback == NO_ROLLBACK){
+        return;
+    }
+    
+    // Go back to the state before the mispredicted step and replay everything since
+    state = slots[pendingRollback % ROLLBACK_WINDOW].before;
+    for(uint32_t step = pendingRollback; step < frame; ++step){
+        FrameSlot& slot = slots[step % ROLLBACK_WINDOW];
+        unsigned predicted = slot.events;
+        Simulate(slot);
+        
+        // Only what the mispredicted run didn't already report
+        untakenEvents |= slot.events & ~predicted;
+    }
+    
+    uint32_t depth = frame - pendingRollback;
+    ++stats.rollbacks;
+    stats.resimulatedSteps += depth;
+    if(depth > stats.deepestRollback){
+        stats.deepestRollback = depth;
+    }
+    pendingRollback = NO_ROLLBACK;
+}
+
+void RollbackSession::Advance(PlayerInput local){
+    Resolve();
+    
+    FrameSlot& slot = slots[frame % ROLLBACK_WINDOW];
+    slot.frame = frame;
+    slot.local = local;
+    Simulate(slot);
+    untakenEvents |= slot.events;
+    ++frame;
+}
+
+unsigned RollbackSession::TakeEvents(){
+    unsigned events = untakenEvents;
+    untakenEvents = EVENT_NONE;
+    return events;
+}
+
+PlayerInput RollbackSession::LocalInput(uint32_t step) const{
+    FrameSlot const& slot = slots[step % ROLLBACK_WINDOW];
+    return (slot.frame == step) ? slot.local : 0;
+}
+
+} // namespace pong
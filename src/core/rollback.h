@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* The buttons of one player: bit 0 is up, bit 1 is down
+*   - Player 0 drives the left paddle, player 1 the right paddle
+*/
+typedef uint8_t PlayerInput;
+
+Inputs CombineInputs(PlayerInput left, PlayerInput right);
+PlayerInput PlayerInputFrom(Inputs const& inputs, int player);
+
+// How many steps the session can run ahead of the last confirmed remote input
+const int ROLLBACK_WINDOW = 128;
+
+struct RollbackStats{
+    uint64_t rollbacks = 0;
+    uint64_t resimulatedSteps = 0;
+    uint32_t deepestRollback = 0;
+};
+
+/*
+* Rollback session for a two-player match where the other player's inputs arrive late
+*   - The simulation never waits for the remote player: a step missing its remote
+*     input runs with a prediction (the last confirmed remote input)
+*   - The state before every step is kept for the last ROLLBACK_WINDOW steps. When
+*     a remote input turns out to differ from what was predicted, the session
+*     restores the state before that step and re-simulates up to the present
+*   - Each step is a pong::Step of FIXED_DT, so re-simulating even the whole window
+*     costs a few microseconds
+*   - Events (hits, goals) are handed out once through TakeEvents(): those of every new
+*     step, plus those a re-simulated step produces that its mispredicted run didn't. An
+*     event that only happened in the mispredicted run has already been reported and
+*     stays reported, there is no taking a sound back
+*   - Transport agnostic: the caller delivers remote inputs and sends local ones
+*/
+class RollbackSession{
+    public:
+        RollbackSession(int localPlayer, GameState initial = NewGame(), CollisionMode mode = CollisionMode::Discrete);
+        
+        // The next step to simulate
+        uint32_t Frame() const { return frame; }
+        
+        // Remote inputs are known for every step before this one
+        uint32_t ConfirmedFrame() const { return confirmedFrame; }
+        
+        // False when running further ahead would leave the rollback window
+        bool CanAdvance() const { return frame < confirmedFrame + ROLLBACK_WINDOW - 1; }
+        
+        /*
+        * Delivers the remote player's input for `step`
+        *   - Duplicates are ignored, so the same input may be sent many times
+        *   - If it contradicts the prediction a step was simulated with, a rollback
+        *     is scheduled and done by the next Advance() or Resolve()
+        */
+        void AddRemoteInput(uint32_t step, PlayerInput input);
+        
+        // Simulates one step with the local player's input
+        void Advance(PlayerInput local);
+        
+        // Applies a scheduled rollback without simulating a new step
+        void Resolve();
+        
+        // The events not taken yet, of new steps and of steps a rollback corrected
+        unsigned TakeEvents();
+        
+        // The local input of an already simulated step, for sending to the peer
+        PlayerInput LocalInput(uint32_t step) const;
+        
+        GameState const& State() const { return state; }
+        RollbackStats const& Stats() const { return stats; }
+        
+    private:
+        static const uint32_t NO_ROLLBACK = 0xFFFFFFFFu;
+        
+        // The state before a step and the inputs it was simulated with
+        struct FrameSlot{
+            uint32_t frame = NO_ROLLBACK;
+            GameState before;
+            PlayerInput local = 0;
+            PlayerInput remoteUsed = 0;
+            unsigned events = EVENT_NONE;
+        };
+        
+        // Remote inputs may arrive up to a window ahead of the simulation, hence twice the size
+        struct RemoteSlot{
+            uint32_t frame = NO_ROLLBACK;
+            PlayerInput input = 0;
+        };
+        
+        PlayerInput RemoteFor(uint32_t step) const;
+        void Simulate(FrameSlot& slot);
+        
+        int localPlayer;
+        CollisionMode mode;
+        GameState state;
+        uint32_t frame = 0;
+        uint32_t confirmedFrame = 0;
+        uint32_t pendingRollback = NO_ROLLBACK;
+        unsigned untakenEvents = EVENT_NONE;
+        FrameSlot slots[ROLLBACK_WINDOW];
+        RemoteSlot remote[2 * ROLLBACK_WINDOW];
+        RollbackStats stats;
+};
+
+} // namespace pong
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+* What goes into and comes out of one simulation step
+*   - Plain enums and structs with no functions, so the batch kernels can include
+*     them from translation units built with other instruction set flags
+*/
+
+namespace pong {
+
+// Stores the state of the buttons 
+enum Buttons{
+    PaddleLeftUp = 0,
+    PaddleLeftDown,
+    PaddleRightUp,
+    PaddleRightDown,
+};
+
+// The buttons held during one simulation step
+struct Inputs{
+    bool buttons[4] = {false, false, false, false};
+};
+
+/*
+* A button pressed or released partway through a step
+*   - time is in milliseconds from the start of the step, 0 to dt
+*/
+struct InputEvent{
+    float time;
+    Buttons button;
+    bool pressed;
+};
+
+/*
+* Flags describing what happened during the last step
+*   - The frontend uses them to play sounds and refresh the score display
+*/
+enum StepEvent : unsigned{
+    EVENT_NONE = 0,
+    EVENT_PADDLE_HIT = 1u << 0,
+    EVENT_WALL_HIT = 1u << 1,
+    EVENT_LEFT_SCORED = 1u << 2,
+    EVENT_RIGHT_SCORED = 1u << 3,
+    
+    // Two balls bounced off each other, only in arena mode
+    EVENT_BALL_HIT = 1u << 4,
+};
+
+} // namespace pong
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace pong {
+
+/*
+*2D Vector class
+*   - x, y are the coordinates of the vector, of scalar type T (float or Fixed)
+*   - Here some convienent operators are overloaded so
+*     we can do something like `position += velocity * time`
+*/
+template<typename T>
+class BasicVec2{
+    public:
+        T x, y;
+        
+        BasicVec2() : x(0), y(0) {}
+        BasicVec2(T x, T y): x(x), y(y) {}
+        
+        BasicVec2 operator+(BasicVec2 const& rhs) const{
+            return BasicVec2(x + rhs.x, y + rhs.y);
+        }
+        
+        BasicVec2& operator+=(BasicVec2 const& rhs){
+            x += rhs.x;
+            y += rhs.y;
+            return *this;
+        }
+        
+        BasicVec2 operator*(T rhs) const{
+            return BasicVec2(x * rhs, y * rhs);
+        }
+};
+
+using Vec2 = BasicVec2<float>;
+
+// Linearly interpolates between two positions, alpha = 0 gives `from` and alpha = 1 gives `to`
+inline Vec2 Lerp(Vec2 const& from, Vec2 const& to, float alpha){
+    return Vec2(from.x + (to.x - from.x) * alpha, from.y + (to.y - from.y) * alpha);
+}
+
+} // namespace pong
@@ -0,0 +1,47 @@
+#include "dirty_region.h"
+
+// Past half the window, one full redraw costs less than many partial ones
+static const int FULL_AREA_DIVISOR = 2;
+
+DirtyRegion::DirtyRegion(int width, int height) : bounds{0, 0, width, height} {}
+
+void DirtyRegion::Clear(){
+    count = 0;
+    area = 0;
+    full = false;
+}
+
+void DirtyRegion::Add(SDL_Rect const& rect){
+    SDL_Rect merged;
+    if(full || !SDL_IntersectRect(&rect, &bounds, &merged)){
+        return;
+    }
+    
+    // Absorb every rect the new one touches, the grown rect may touch others in turn
+    for(int i = 0; i < count;){
+        if(SDL_HasIntersection(&rects[i], &merged)){
+            SDL_UnionRect(&rects[i], &merged, &merged);
+            area -= rects[i].w * rects[i].h;
+            rects[i] = rects[--count];
+            i = 0;
+        }else{
+            ++i;
+        }
+    }
+    
+    if(count == MAX_RECTS){
+        full = true;
+        return;
+    }
+    rects[count++] = merged;
+    area += merged.w * merged.h;
+    if(area > bounds.w * bounds.h / FULL_AREA_DIVISOR){
+        full = true;
+    }
+}
+
+void DirtyRegion::AddMove(SDL_Rect const& from, SDL_Rect const& to){
+    SDL_Rect swept;
+    SDL_UnionRect(&from, &to, &swept);
+    Add(swept);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+/*
+* The parts of the window that changed since the last frame
+*   - Anything that moved adds the bounding box of where it was drawn last frame and
+*     where it is drawn now, a small rect since nothing moves far between two frames
+*   - Overlapping rects are merged, so no pixel is redrawn or pushed to the window twice
+*   - Rects are clipped to the window, an object partly off screen adds only what is visible
+*   - Once there are too many rects, or they cover too much of the window, Full() says
+*     to redraw and push everything instead, which is cheaper by then
+*/
+class DirtyRegion{
+    public:
+        static const int MAX_RECTS = 16;
+        
+        DirtyRegion(int width, int height);
+        
+        // Starts a new frame with nothing dirty
+        void Clear();
+        
+        void Add(SDL_Rect const& rect);
+        void AddMove(SDL_Rect const& from, SDL_Rect const& to);
+        
+        // Everything has to be redrawn this frame
+        void MarkFull() { full = true; }
+        
+        bool Full() const { return full; }
+        SDL_Rect const* Rects() const { return rects; }
+        int Count() const { return count; }
+        
+    private:
+        SDL_Rect bounds;
+        SDL_Rect rects[MAX_RECTS];
+        int count = 0;
+        int area = 0;
+        bool full = false;
+};
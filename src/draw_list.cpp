@@ -0,0 +1,56 @@
+#include "draw_list.h"
+
+DrawList::DrawList(){
+    // The net plus the ball and both paddles
+    rects.reserve(256);
+}
+
+void DrawList::Clear(){
+    rects.clear();
+}
+
+void DrawList::AddRect(SDL_Rect const& rect){
+    rects.push_back(rect);
+}
+
+void DrawList::AddRects(std::vector<SDL_Rect> const& more){
+    rects.insert(rects.end(), more.begin(), more.end());
+}
+
+void DrawList::Submit(SDL_Renderer* renderer) const{
+    if(!rects.empty()){
+        SDL_RenderFillRects(renderer, rects.data(), static_cast<int>(rects.size()));
+    }
+}
+
+std::vector<SDL_Rect> BuildNetRects(int x, int height){
+    std::vector<SDL_Rect> net;
+    
+    // Runs of consecutive y with y%5 != 0 become one rect each
+    int y = 0;
+    while(y < height){
+        if(y % 5 == 0){
+            ++y;
+            continue;
+        }
+        int start = y;
+        while(y < height && y % 5 != 0){
+            ++y;
+        }
+        net.push_back({x, start, 1, y - start});
+    }
+    return net;
+}
+
+SDL_Rect InterpolatedRect(pong::Vec2 const& previousPosition, pong::Vec2 const& position, int w, int h, float alpha){
+    pong::Vec2 drawPosition = pong::Lerp(previousPosition, position, alpha);
+    return SDL_Rect{static_cast<int>(drawPosition.x), static_cast<int>(drawPosition.y), w, h};
+}
+
+SDL_Rect BallRect(pong::Ball const& ball, float alpha){
+    return InterpolatedRect(ball.previousPosition, ball.position, pong::BALL_WIDTH, pong::BALL_HEIGHT, alpha);
+}
+
+SDL_Rect PaddleRect(pong::Paddle const& paddle, float alpha){
+    return InterpolatedRect(paddle.previousPosition, paddle.position, pong::PADDLE_WIDTH, pong::PADDLE_HEIGHT, alpha);
+}
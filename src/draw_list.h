@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+#include "core/ball.h"
+#include "core/paddle.h"
+
+/*
+* Collects the filled rectangles of a frame and submits them together
+*   - Everything in one list shares the renderer's current draw color
+*   - Submit() draws all of them with a single SDL_RenderFillRects call,
+*     which is much cheaper than one SDL_RenderFillRect/DrawPoint call each
+*   - The storage is kept between frames, so clearing and refilling doesn't allocate
+*/
+class DrawList{
+    public:
+        DrawList();
+        
+        void Clear();
+        void AddRect(SDL_Rect const& rect);
+        void AddRects(std::vector<SDL_Rect> const& more);
+        void Submit(SDL_Renderer* renderer) const;
+        
+        std::vector<SDL_Rect> const& Rects() const { return rects; }
+        
+    private:
+        std::vector<SDL_Rect> rects;
+};
+
+/*
+* The dashes of the net as rectangles
+*   - Same pattern as drawing a point at every y where y%5 != 0, merged into
+*     one 1 x 4 rect per dash, so the net costs a handful of rects instead of
+*     hundreds of points
+*/
+std::vector<SDL_Rect> BuildNetRects(int x, int height);
+
+/*
+* The rectangle covering a w x h object at the given position
+*   - alpha is how far the current frame lies between the previous and the current
+*     simulation step, so objects are drawn between their last two positions
+*/
+SDL_Rect InterpolatedRect(pong::Vec2 const& previousPosition, pong::Vec2 const& position, int w, int h, float alpha);
+SDL_Rect BallRect(pong::Ball const& ball, float alpha);
+SDL_Rect PaddleRect(pong::Paddle const& paddle, float alpha);
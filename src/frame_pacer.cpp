@@ -0,0 +1,42 @@
+#include "frame_pacer.h"
+
+/*
+* SDL_Delay may oversleep by a millisecond or two depending on the OS timer,
+* so the limiter stops sleeping this long before the deadline and spins the rest
+*/
+static const Uint64 SPIN_MICROSECONDS = 2000;
+
+FramePacer::FramePacer(PacingMode mode, int targetFps) : mode(mode){
+    frequency = SDL_GetPerformanceFrequency();
+    period = frequency / static_cast<Uint64>(targetFps);
+}
+
+Uint32 FramePacer::RendererFlags() const{
+    return (mode == PacingMode::Vsync) ? SDL_RENDERER_PRESENTVSYNC : 0;
+}
+
+void FramePacer::EndFrame(){
+    if(mode != PacingMode::Limit){
+        return;
+    }
+    
+    Uint64 now = SDL_GetPerformanceCounter();
+    if(nextFrame == 0){
+        nextFrame = now;
+    }
+    nextFrame += period;
+    
+    // More than a whole frame behind: start over from now instead of rushing to catch up
+    if(now > nextFrame + period){
+        nextFrame = now;
+        return;
+    }
+    
+    Uint64 spin = SPIN_MICROSECONDS * frequency / 1000000;
+    if(nextFrame > now + spin){
+        SDL_Delay(static_cast<Uint32>((nextFrame - now - spin) * 1000 / frequency));
+    }
+    
+    while(SDL_GetPerformanceCounter() < nextFrame){
+    }
+}
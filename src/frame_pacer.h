@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+/*
+* How the main loop paces its frames
+*   - Vsync lets SDL_RenderPresent wait for the display refresh
+*   - Limit sleeps, then spins for the last stretch, until the next frame is due at a target rate
+*   - Uncapped renders as fast as possible, like the original loop
+*/
+enum class PacingMode{
+    Uncapped,
+    Vsync,
+    Limit
+};
+
+class FramePacer{
+    public:
+        FramePacer(PacingMode mode, int targetFps);
+        
+        // Flags to pass to SDL_CreateRenderer for this mode
+        Uint32 RendererFlags() const;
+        
+        /*
+        * Called once per frame after presenting
+        *   - In Limit mode it returns when the next frame is due, otherwise at once
+        */
+        void EndFrame();
+        
+        /*
+        * Whether static screens should block on SDL_WaitEventTimeout and only redraw
+        * when something changes, instead of redrawing every frame
+        */
+        bool WaitOnStaticScreens() const { return mode != PacingMode::Uncapped; }
+        
+    private:
+        PacingMode mode;
+        Uint64 frequency;
+        Uint64 period;
+        Uint64 nextFrame = 0;
+};
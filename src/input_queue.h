@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "core/game.h"
+
+// A button pressed or released at a point in time, on the steady clock
+struct ButtonChange{
+    std::chrono::steady_clock::time_point time;
+    pong::Buttons button;
+    bool pressed;
+};
+
+/*
+* Lock-free queue of button changes from the thread polling events to the simulation thread
+*   - One producer and one consumer, each owning one end of a fixed ring
+*   - A full queue drops the newest change; at 256 entries that takes hundreds of
+*     key changes between two simulation steps
+*/
+class InputQueue{
+    public:
+        static const std::size_t CAPACITY = 256;
+        
+        bool Push(ButtonChange const& change){
+            std::size_t tail = this->tail.load(std::memory_order_relaxed);
+            std::size_t next = (tail + 1) % CAPACITY;
+            if(next == head.load(std::memory_order_acquire)){
+                return false;
+            }
+            ring[tail] = change;
+            this->tail.store(next, std::memory_order_release);
+            return true;
+        }
+        
+        bool Pop(ButtonChange& change){
+            std::size_t head = this->head.load(std::memory_order_relaxed);
+            if(head == tail.load(std::memory_order_acquire)){
+                return false;
+            }
+            change = ring[head];
+            this->head.store((head + 1) % CAPACITY, std::memory_order_release);
+            return true;
+        }
+        
+    private:
+        ButtonChange ring[CAPACITY];
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+};
@@ -1,41 +1,41 @@
+#include <algorithm>
 #include <chrono>
-#include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_mixer.h>
 
-const int WINDOW_WIDTH = 1280;
-const int WINDOW_HEIGHT = 720;
-const int BALL_WIDTH = 15;
-const int BALL_HEIGHT = 15;
-const int PADDLE_WIDTH = 10;
-const int PADDLE_HEIGHT = 100;
-const float PADDLE_SPEED = 1.0f;
-const float BALL_SPEED = 1.0f;
+#include "allocation_tracker.h"
+#include "assets.h"
+#include "core/game.h"
+#include "dirty_region.h"
+#include "draw_list.h"
+#include "player_score.h"
+#include "frame_pacer.h"
+#include "options.h"
+#include "profiler.h"
+#include "simulation.h"
+#include "simulation_thread.h"
+#include "sound_board.h"
+#include "text_atlas.h"
+#include "video_recorder.h"
 
-// Stores the state of the buttons 
-enum Buttons{
-    PaddleLeftUp = 0,
-    PaddleLeftDown,
-    PaddleRightUp,
-    PaddleRightDown,
-};
+using pong::Vec2;
+using pong::WINDOW_WIDTH;
+using pong::WINDOW_HEIGHT;
+using pong::FIXED_DT;
 
-// Stores the type of collision
-enum class CollisionType{
-    None,
-    Top,
-    Middle,
-    Bottom,
-    Left,
-    Right
-};
+/*
+* A frame that would need more than MAX_STEPS_PER_FRAME fixed steps
+* drops the excess so the game slows down instead of spiralling.
+*/
+const int MAX_STEPS_PER_FRAME = 12;
 
-// Stores the collision information
-struct Contact{
-    CollisionType type;
-    float penetration;
-};
+// Longest a static screen blocks waiting for an event before checking again
+const int STATIC_SCREEN_TIMEOUT_MS = 250;
+
+// Frames --alloc-check draws the start screen for after its warm-up, before starting the match
+const int START_SCREEN_CHECK_FRAMES = 30;
 
 // Define game states
 enum GameState {
@@ -44,346 +44,285 @@ enum GameState {
     EXIT
 };
 
-/*
-*2D Vector class  
-*   - x, y are the coordinates of the vector
-*   - Here some convienent operators are overloaded so
-*     we can do something like `position += velocity * time` 
-*/
-class Vec2{
-    public:
-        float x, y;
-        
-        Vec2() : x(0.0f), y(0.0f) {}
-        Vec2(float x, float y): x(x), y(y) {}
-        
-        Vec2 operator+(Vec2 const& rhs){
-            return Vec2(x + rhs.x, y + rhs.y);
-        }
-        
-        Vec2& operator+=(Vec2 const& rhs){
-            x += rhs.x;
-            y += rhs.y;
-            return *this;
-        }      
-
-        Vec2 operator*(float rhs){
-            return Vec2(x * rhs, y * rhs);
-        }
-};
-
-class Ball{
-    public:
-        Vec2 position;
-        Vec2 velocity;
-        SDL_Rect rect;
-        
-        Ball(Vec2 position, Vec2 velocity): position(position), velocity(velocity){
-            rect.x = static_cast<int>(position.x);
-            rect.y = static_cast<int>(position.y);
-            rect.h = BALL_HEIGHT;
-            rect.w = BALL_WIDTH;
-        }   
-        
-        void update(float dt){
-            position += velocity * dt;
-        }
-        
-        void Draw(SDL_Renderer *renderer){
-            rect.x = static_cast<int>(position.x);
-            rect.y = static_cast<int>(position.y);
-            
-            // Fills the rectangle on the current rendering target with the drawing color.
-            SDL_RenderFillRect(renderer, &rect);
-        }
-        
-        void CollideWithPaddle(Contact const& contact){
-            position.x += contact.penetration;
-            velocity.x = -velocity.x;
-            
-            if (contact.type == CollisionType::Top) {
-                velocity.y = -.75f * BALL_SPEED;
-            } else if (contact.type == CollisionType::Bottom) {
-                velocity.y = .75f * BALL_SPEED;
-            }
-        }
-        
-        /*
-        * CollideWithWall function is called when the ball collides with the wall
-        *  - If the ball collides with the top or bottom wall, the y velocity is reversed
-        *  - If the ball collides with the left or right wall, the ball is reset to the center
-        */
-        void CollideWithWall(Contact const& contact){
-            if((contact.type == CollisionType::Top) ||contact.type == CollisionType::Bottom){
-                position.y += contact.penetration;
-                velocity.y = -velocity.y;
-            }else if(contact.type == CollisionType::Left){
-                position.x = WINDOW_WIDTH / 2.0f;
-                position.y = WINDOW_HEIGHT / 2.0f;
-                velocity.x = BALL_SPEED;
-                velocity.y = 0.75f * BALL_SPEED;
-            }else if(contact.type == CollisionType::Right){
-                position.x = WINDOW_WIDTH / 2.0f;
-                position.y = WINDOW_HEIGHT / 2.0f;
-                velocity.x = -BALL_SPEED;
-                velocity.y = 0.75f * BALL_SPEED;
-            }
-        }
-};
- class Paddle{
-    public:
-        Vec2 position;
-        Vec2 velocity;
-        SDL_Rect rect;
-        
-        Paddle(Vec2 position, Vec2 velocity) :  position(position), velocity(velocity){
-            rect.x = static_cast<int>(position.x);
-            rect.y = static_cast<int>(position.y);
-            rect.h = PADDLE_HEIGHT;
-            rect.w = PADDLE_WIDTH;
-        }  
-        
-        void update(float dt){
-            
-            // Update the position of the paddle
-            position += velocity * dt;
-            
-            if(position.y < 0){
-                
-                // If paddle is on the top of the window, set it to 0
-                position.y = 0;
-            }else if(position.y > (WINDOW_HEIGHT - PADDLE_HEIGHT)){
-                
-                // If paddle is on the bottom of the window, set it to the bottom
-                position.y = WINDOW_HEIGHT - PADDLE_HEIGHT;
-            }
-        }
-        
-        void Draw(SDL_Renderer * renderer){
-            rect.x = static_cast<int>(position.x);
-            rect.y = static_cast<int>(position.y);
-            
-            // Fills the rectangle on the current rendering target with the drawing color.
-            SDL_RenderFillRect(renderer, &rect);
-        }
-};
-
-class PlayerScore{
-    public:
-        SDL_Renderer* renderer; 
-        TTF_Font* font;
-        SDL_Surface* surface;
-        SDL_Texture* texture;
-        SDL_Rect rect;
-        
-        PlayerScore(Vec2 position, SDL_Renderer * renderer, TTF_Font* font) : renderer(renderer) , font(font){
-            
-            int width, height;
-            
-            /*
-            * TTF_RenderText_Solid will allocate a new 8-bit, palettized surface. The surface's
-            * 0 pixel will be the colorkey, giving a transparent background. The 1 pixel
-            * will be set to the text color.
-            */
-            surface = TTF_RenderText_Solid(font, "0", {0xFF, 0xFF, 0xFF, 0xFF});
-            
-            // Creates a texture from a surface 
-            // Any time the score changes, a new surface and texture must be created, and the old ones are destroyed.
-            texture = SDL_CreateTextureFromSurface(renderer, surface);
-           
-            // Query the width and height of the texture 
-    		SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
-            
-    		rect.x = static_cast<int>(position.x);
-    		rect.y = static_cast<int>(position.y);
-    		rect.w = width;
-    		rect.h = height;
-        }
-        
-        // Destructor to free the surface and texture
-        ~PlayerScore(){
-            SDL_FreeSurface(surface);
-            SDL_DestroyTexture(texture);
-        }
-        
-        void Draw(){
-            
-            //This copies a portion of the texture to the current rendering target.
-            SDL_RenderCopy(renderer, texture, nullptr, &rect);
-        }
-        
-        
-        /*
-        * setScore function is called when the score changes 
-        * - The old surface and texture are freed
-        * - A new surface and texture are created with the new score
-        */
-        void setScore(int score){
-            SDL_FreeSurface(surface);
-            SDL_DestroyTexture(texture);
-            
-            surface = TTF_RenderText_Solid(font, std::to_string(score).c_str(), {0xFF, 0xFF, 0xFF, 0xFF});
-            texture = SDL_CreateTextureFromSurface(renderer, surface);
-            
-            int width, height;
-            SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
-            rect.w = width;
-            rect.h = height;
-        }
-};
+// The paddle button a key drives, false for other keys
+static bool KeyButton(SDL_Keycode key, pong::Buttons& button){
+    switch(key){
+        case SDLK_w:
+            button = pong::Buttons::PaddleLeftUp;
+            return true;
+        case SDLK_s:
+            button = pong::Buttons::PaddleLeftDown;
+            return true;
+        case SDLK_k:
+            button = pong::Buttons::PaddleRightUp;
+            return true;
+        case SDLK_j:
+            button = pong::Buttons::PaddleRightDown;
+            return true;
+    }
+    return false;
+}
 
-/* To detect a collision between the balls and the paddles,
-*  we’ll make use of something called the Separating Axis Theorem (SAT). 
-*       -The SAT says (in simplified terms) that if you can show that 
-*        the projections of two objects onto an axis have a gap, 
-*        then the objects are not colliding. 
+/*
+* Shows what was drawn since the last present
+*   - A surface renderer has drawn straight into the window surface, which is pushed to
+*     the screen whole, or only the dirty rects of a `dirty` region that isn't full
 */
-
-Contact CheckPaddleCollision(Ball const& ball, Paddle const& paddle){
-    float ballLeft = ball.position.x;
-    float ballRight = ball.position.x + BALL_WIDTH;
-    float ballTop = ball.position.y;
-    float ballBottom = ball.position.y + BALL_HEIGHT;
-
-    float paddleLeft = paddle.position.x;
-    float paddleRight = paddle.position.x + PADDLE_WIDTH;
-    float paddleTop = paddle.position.y;
-    float paddleBottom = paddle.position.y + PADDLE_HEIGHT;
-
-    Contact contact{};
-    
-    // No collision if the ball is to the left, right, above, or below the paddle
-    if(ballLeft >= paddleRight)
-        return contact;
-
-    if( ballRight <= paddleLeft)
-        return contact;
-    
-    if(ballTop >= paddleBottom)
-        return contact;
-    
-    if(ballBottom <= paddleTop)
-        return contact;
-    
-    // Calculate the range of the paddle where the ball collided    
-    float paddleRangeUpper = paddleBottom - (2.0f * PADDLE_HEIGHT / 3.0f);
-    float paddleRangeMiddle = paddleBottom - (PADDLE_HEIGHT / 3.0f);
-    
-    if(ball.velocity.x < 0){
-        // Left paddle collision
-        contact.penetration = paddleRight - ballLeft;
-    }else if(ball.velocity.x > 0){
-        // Right paddle collision
-        contact.penetration = paddleLeft - ballRight;
-    }
-  
-    // Determine the type of collision based on the range of the paddle where the ball collided
-    if((ballBottom > paddleTop) && (ballBottom < paddleRangeUpper)){
-        contact.type = CollisionType::Top;
-    }else if((ballBottom > paddleRangeUpper) && (ballBottom < paddleRangeMiddle)){
-        contact.type = CollisionType::Middle;
-    }else{
-        contact.type = CollisionType::Bottom;
+static void Present(SDL_Window* window, SDL_Renderer* renderer, bool surfaceRendering, DirtyRegion const* dirty = nullptr){
+    if(!surfaceRendering){
+        SDL_RenderPresent(renderer);
+        return;
     }
     
-    return contact;
+    // The renderer may still hold batched draw calls
+    SDL_RenderFlush(renderer);
+    if(dirty == nullptr || dirty->Full()){
+        SDL_UpdateWindowSurface(window);
+    }else if(dirty->Count() > 0){
+        SDL_UpdateWindowSurfaceRects(window, dirty->Rects(), dirty->Count());
+    }
 }
 
-Contact CheckWallCollision(Ball const& ball){
-    float ballLeft = ball.position.x;
-    float ballRight = ball.position.x + BALL_WIDTH;
-    float ballTop = ball.position.y;
-    float ballBottom = ball.position.y + BALL_HEIGHT;
+int main(int argc, char* argv[]){
+    Options options;
+    if(!ParseOptions(argc, argv, options)){
+        return 1;
+    }
+    FramePacer pacer(options.pacing, options.targetFps);
     
-    Contact contact{};
+    // Count what SDL allocates from the start, see allocation_tracker.h
+    InstallAllocationHooks();
     
-    if(ballLeft < 0.0f){
-        contact.type = CollisionType::Left;
-    }else if(ballRight > WINDOW_WIDTH){
-        contact.type = CollisionType::Right;
-    }else if(ballTop < 0.0f){
-        contact.type = CollisionType::Top;
-        contact.penetration = -ballTop;
-    }else if(ballBottom > WINDOW_HEIGHT){
-        contact.type = CollisionType::Bottom;
-        contact.penetration = WINDOW_HEIGHT - ballBottom;
-    }
-    return contact;
-}
-
-// Function to render text
-void RenderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& message, SDL_Color color, int x, int y) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, message.c_str(), color);
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_Rect dstRect = { x, y, surface->w, surface->h };
-    SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-}
-
-int main(){
 	// Initialize SDL components
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
     TTF_Init();
-    Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048);
+    
+    // Small audio buffers so a hit is heard within a few milliseconds, the game runs on without sound if this fails
+    SoundBoard sounds;
+    if(sounds.Open(options.audio)){
+        SDL_Log("Audio buffer: %.1f ms", sounds.BufferMs());
+    }
     
 	// Creates a window with the specified position, dimensions, and flags.
 	SDL_Window* window = SDL_CreateWindow("Pong", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
-	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, 0);
 	
-    // Initialize the font
-    TTF_Font* scoreFont = TTF_OpenFont("assets/font/DejaVuSansMono.ttf", 40);
+	/*
+	* With --renderer=software everything is drawn on the CPU into the window surface
+	*   - SDL's software renderer draws there, so the atlases and the draw list work unchanged
+	*   - Only the parts of the surface that changed are redrawn and pushed, see DirtyRegion
+	*   - Updating a window surface doesn't wait for vsync, so vsync pacing becomes a limit
+	*     at the display's refresh rate
+	*/
+	bool surfaceRendering = false;
+	SDL_Renderer* renderer = nullptr;
+	if(options.softwareRenderer){
+	    SDL_Surface* surface = SDL_GetWindowSurface(window);
+	    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+	    if(renderer){
+	        surfaceRendering = true;
+	        if(options.pacing == PacingMode::Vsync){
+	            SDL_DisplayMode display;
+	            bool known = SDL_GetWindowDisplayMode(window, &display) == 0 && display.refresh_rate > 0;
+	            pacer = FramePacer(PacingMode::Limit, known ? display.refresh_rate : 60);
+	        }
+	    }else{
+	        SDL_Log("Software rendering unavailable, using the default renderer: %s", SDL_GetError());
+	    }
+	}
+	if(!renderer){
+	    renderer = SDL_CreateRenderer(window, -1, pacer.RendererFlags());
+	}
+	
+    // Initialize the font, both sizes read the one embedded copy of it
+    TTF_Font* scoreFont = TTF_OpenFontRW(OpenAsset("font/DejaVuSansMono.ttf"), 1, 40);
     if (!scoreFont) {
         SDL_Log("Failed to load score font: %s", TTF_GetError());
         return -1;
     }
-    TTF_Font* messageFont = TTF_OpenFont("assets/font/DejaVuSansMono.ttf", 20);
+    TTF_Font* messageFont = TTF_OpenFontRW(OpenAsset("font/DejaVuSansMono.ttf"), 1, 20);
     if (!messageFont) {
         SDL_Log("Failed to load message font: %s", TTF_GetError());
         return -1;
     }
 	
 	//Initialize sound effects
-	Mix_Chunk* wallHitSound = Mix_LoadWAV("assets/audio/WallHit.wav");
-	Mix_Chunk* paddleHitSound = Mix_LoadWAV("assets/audio/PaddleHit.wav");
+	sounds.Load(Sound::WallHit, "audio/WallHit.wav");
+	sounds.Load(Sound::PaddleHit, "audio/PaddleHit.wav");
 	
-	/*
-    * Ball object is created and it's initial position is set to the center of the window.
-    *   - Half of the ball’s width and height are subtracted from the x and y
-	*     values because SDL2 considers the origin of an
-	*     object to be the upper left corner
-	*/
-	Ball ball(Vec2(WINDOW_WIDTH/2.0f - BALL_WIDTH/2.0f , WINDOW_HEIGHT/2.0f - BALL_HEIGHT/2.0f), Vec2(BALL_SPEED, 0.0f));
-
-	/*
-	* Paddle objects are created and their initial positions are set to the left and right
-	*/
-	Paddle paddleLeft(Vec2(50.0f, WINDOW_HEIGHT/2.0f - PADDLE_HEIGHT/2.0), Vec2(0.0f, 0.0f));
-	Paddle paddleRight(Vec2( WINDOW_WIDTH - 50.0f , WINDOW_HEIGHT/2.0f - PADDLE_HEIGHT/2.0), Vec2(0.0f, 0.0f));
-	
-	/* 
-	* PlayerScore objects are created and their initial positions are set. 
-	*/
-	PlayerScore playerLeftScore(Vec2(WINDOW_WIDTH/4.0f, 20), renderer, scoreFont);
-	PlayerScore playerRightScore(Vec2(3 * WINDOW_WIDTH/4.0f, 20), renderer, scoreFont);
+	// Non-zero when --alloc-check found a frame that allocated
+	int exitCode = 0;
 	
-	// Game logic
+	// Game logic, scoped so everything holding a texture is gone before the renderer is destroyed
 	{
-	    int leftPlayerScore = 0;
-	    int rightPlayerScore  = 0;
+	    // Rasterize each font's glyphs once, all text is drawn from these atlases
+	    GlyphAtlas scoreAtlas(renderer, scoreFont);
+	    GlyphAtlas messageAtlas(renderer, messageFont);
+	    
+	    /* 
+	    * PlayerScore objects are created and their initial positions are set. 
+	    */
+	    PlayerScore playerLeftScore(Vec2(WINDOW_WIDTH/4.0f, 20), scoreAtlas);
+	    PlayerScore playerRightScore(Vec2(3 * WINDOW_WIDTH/4.0f, 20), scoreAtlas);
+	    
+	    /*
+	    * All white rectangles of a frame go through one draw list
+	    *   - The net never changes, so its rects are built once and copied in each frame
+	    */
+	    DrawList drawList;
+	    
+	    /*
+	    * The parts of the window to redraw each frame when drawing into the window surface
+	    *   - The drawn* rects are where the ball and the paddles are on screen
+	    *   - fullRedraw is set whenever something else may have drawn over the playfield
+	    */
+	    DirtyRegion dirty(WINDOW_WIDTH, WINDOW_HEIGHT);
+	    SDL_Rect drawnBall = {0, 0, 0, 0};
+	    SDL_Rect drawnLeftPaddle = {0, 0, 0, 0};
+	    SDL_Rect drawnRightPaddle = {0, 0, 0, 0};
+	    bool fullRedraw = true;
+	    
+	    // Per-phase timing, shown with F1 and optionally written to a trace and a CSV file
+	    Profiler profiler;
+	    if(options.tracePath && !profiler.OpenTrace(options.tracePath)){
+	        SDL_Log("Failed to open trace file: %s", options.tracePath);
+	    }
+	    if(options.profileCsvPath && !profiler.OpenCsv(options.profileCsvPath)){
+	        SDL_Log("Failed to open profile file: %s", options.profileCsvPath);
+	    }
+	    const std::vector<SDL_Rect> netRects = BuildNetRects(WINDOW_WIDTH/2, WINDOW_HEIGHT);
 	
 	    bool running = true;
-		bool buttons[4] = {false};
+	    
+	    /*
+	    * With --video every PLAYING frame is drawn into an offscreen target, recorded, then
+	    * copied to the window
+	    *   - Each frame advances the game by exactly one video frame however long it took, so
+	    *     the video plays at the right speed, and with --pacing=uncapped (say under
+	    *     SDL_VIDEODRIVER=dummy with --replay) it renders faster than real time
+	    */
+	    VideoRecorder video;
+	    SDL_Texture* videoTarget = nullptr;
+	    const float videoFrameMs = 1000.0f / options.videoFps;
+	    if(options.videoPath){
+	        videoTarget = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+	        if(!videoTarget){
+	            SDL_Log("Failed to create the video target: %s", SDL_GetError());
+	            running = false;
+	        }else if(!video.Open(options.videoPath, WINDOW_WIDTH, WINDOW_HEIGHT, options.videoFps)){
+	            SDL_Log("Failed to open video file: %s", options.videoPath);
+	            running = false;
+	        }
+	    }
 		
-		float dt = 0.0f;
+		/*
+		* Fixed timestep state, used when the simulation runs on this thread
+		*   - accumulator holds the measured time (ms) not yet consumed by simulation steps
+		*   - previousTime is sampled once per loop iteration, on every screen, so the first
+		*     PLAYING frame after the start screen never sees a stale frame time
+		*/
+		float accumulator = 0.0f;
+		auto previousTime = std::chrono::steady_clock::now();
 		
 		GameState gameState = START_SCREEN;
 		
+		// The match or arena, replays, recording and netplay
+		Simulation simulation(options);
+		if(!simulation.Ok()){
+		    running = false;
+		}
+		
+		/*
+		* Threading
+		*   - By default the simulation steps on its own thread from the moment play starts,
+		*     and this loop only handles events, sound and drawing the newest snapshot
+		*   - With --sim-thread=off the steps run here between frames, with their phases profiled
+		*   - A video steps here too, on its own clock instead of the wall clock
+		*/
+		bool threaded = options.simulationThread && !options.videoPath;
+		SimulationThread simulationThread(simulation);
+		Snapshot localSnapshot;
+		
+		// Entering PLAYING starts the simulation thread once, which has a snapshot ready before the first frame draws
+		auto startPlaying = [&]{
+		    gameState = PLAYING;
+		    if(threaded){
+		        simulationThread.Start();
+		    }
+		};
+		if(simulation.Ok() && simulation.StartsPlaying()){
+		    startPlaying();
+		}
+		
+		// A rollback can change the score without a scoring event, so the shown score is tracked
+		int shownLeftScore = 0;
+		int shownRightScore = 0;
+		
+		// The newest key change whose latency has been measured
+		std::chrono::steady_clock::time_point lastMeasuredInput;
+		
+		// The start screen never changes on its own, it is only redrawn when this is set
+		bool startScreenDirty = true;
+		
+		/*
+		* With --alloc-check every frame after a warm-up on each screen must not allocate
+		*   - What the render and simulation threads allocated since the previous loop iteration
+		*     is charged to the frame that iteration drew, on the screen it started on
+		*   - The start screen is redrawn every frame, and the match starts by itself after it
+		*/
+		bool checkingAllocations = options.allocationCheckFrames > 0;
+		AllocationCheck allocationCheck(options.allocationCheckFrames);
+		uint64_t renderAllocations = 0;
+		uint64_t simulationAllocations = 0;
+		int checkedScreen = -1;
+		int startScreenFrames = 0;
+		
 		// Continue looping and processing events until user exits
 		while (running)
 		{
-		    // Calculate the time taken to render the frame at the start
-            auto startTime = std::chrono::high_resolution_clock::now();  
+		    // SDL's scratch buffers of this frame come from the frame arena
+		    BeginArenaFrame();
+		    
+		    if(checkingAllocations){
+		        uint64_t render = ThreadAllocations() - renderAllocations;
+		        uint64_t simulated = simulationThread.Allocations() - simulationAllocations;
+		        if(checkedScreen >= 0 && allocationCheck.Check(checkedScreen, render + simulated)){
+		            SDL_Log("Frame allocated on the %s: %llu on the render thread, %llu on the simulation thread",
+		                    checkedScreen == PLAYING ? "playfield" : "start screen",
+		                    static_cast<unsigned long long>(render), static_cast<unsigned long long>(simulated));
+		            for(int i = 0; checkedScreen == PLAYING && i < static_cast<int>(Phase::Count); ++i){
+		                Phase phase = static_cast<Phase>(i);
+		                if(profiler.PhaseAllocations(phase) > 0){
+		                    SDL_Log("  %s: %llu", PhaseName(phase), static_cast<unsigned long long>(profiler.PhaseAllocations(phase)));
+		                }
+		            }
+		        }
+		        if(allocationCheck.Done()){
+		            break;
+		        }
+		        
+		        // Logging may allocate itself, so counting starts over after it
+		        checkedScreen = gameState;
+		        renderAllocations = ThreadAllocations();
+		        simulationAllocations = simulationThread.Allocations();
+		    }
+		    
+		    /*
+		    * While the video writer is behind, hold the game still instead of dropping a frame of the video
+		    *   - Before the frame starts, so the wait isn't profiled as part of it, and the
+		    *     window's events are still collected for the frame that follows
+		    */
+		    while(gameState == PLAYING && video.IsOpen() && !video.Ready()){
+		        SDL_PumpEvents();
+		        SDL_Delay(1);
+		    }
+		    
+		    // Measure how long the previous iteration took
+            auto currentTime = std::chrono::steady_clock::now();
+            float frameTime = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - previousTime).count();
+            previousTime = currentTime;
+            
+            // Only PLAYING frames are recorded, a start screen frame is discarded by the next BeginFrame
+            profiler.BeginFrame();
 		
 		    // Creates a new event structure queue
 			SDL_Event event;
@@ -400,12 +339,20 @@ int main(){
             * but will not remove it from the queue.
             */
             
+            profiler.Begin(Phase::Events);
+            auto eventsPolled = std::chrono::steady_clock::now();
 			while (SDL_PollEvent(&event))
 			{
 				if (event.type == SDL_QUIT)
 				{
 					running = false;
 				}
+				else if (event.type == SDL_WINDOWEVENT)
+				{
+				    // Exposed, resized, restored... the window contents may need to be drawn again
+				    startScreenDirty = true;
+				    fullRedraw = true;
+				}
 				else if (event.type == SDL_KEYDOWN)
 				{
     				// event.key.keysym.sym returns the key that was pressed
@@ -413,179 +360,333 @@ int main(){
                         case SDLK_ESCAPE:
                             running = false;
                             break;
+                        case SDLK_F1:
+                            profiler.ToggleOverlay();
+                            break;
                         case SDLK_SPACE:
                             if(gameState == START_SCREEN){
-                                gameState = PLAYING;
+                                startPlaying();
+                                
+                                // Time spent waiting on the start screen must not be simulated
+                                frameTime = 0.0f;
                             }
                             break;
-                        case SDLK_k:
-                            buttons[Buttons::PaddleRightUp] = true;
-                            break;
-                        case SDLK_j:
-                            buttons[Buttons::PaddleRightDown] = true;
-                            break;
-                        case SDLK_w:
-                            buttons[Buttons::PaddleLeftUp] = true;
-                            break;
-                        case SDLK_s:
-                            buttons[Buttons::PaddleLeftDown] = true;
-                            break;
-                    }
-				} else if(event.type == SDL_KEYUP){
-                    switch (event.key.keysym.sym) {
-                        case SDLK_k:
-                            buttons[Buttons::PaddleRightUp] = false;
-                            break;
-                        case SDLK_j:
-                            buttons[Buttons::PaddleRightDown] = false;
-                            break;
-                        case SDLK_w:
-                            buttons[Buttons::PaddleLeftUp] = false;
-                            break;
-                        case SDLK_s:
-                            buttons[Buttons::PaddleLeftDown] = false;
-                            break;
                     }
 				}
+				
+				/*
+				* Paddle keys become button changes stamped with when they happened
+				*   - SDL stamps events in milliseconds of SDL_GetTicks(), which is moved onto the
+				*     steady clock here, so a key pressed early in a long frame still counts from then
+				*   - Auto-repeat is not a change and is ignored
+				*/
+				pong::Buttons button;
+				if((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && !event.key.repeat && KeyButton(event.key.keysym.sym, button)){
+				    Uint32 age = SDL_GetTicks() - event.key.timestamp;
+				    if(event.key.timestamp == 0 || age > 1000){
+				        // No usable timestamp from this backend
+				        age = 0;
+				    }
+				    ButtonChange change{eventsPolled - std::chrono::milliseconds(age), button, event.type == SDL_KEYDOWN};
+				    if(threaded){
+				        simulationThread.AddInput(change);
+				    }else{
+				        simulation.AddInput(change);
+				    }
+				}
 			}
+			profiler.End(Phase::Events);
 
 			if (gameState == START_SCREEN) {
-                // Clear the window to black
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-                SDL_RenderClear(renderer);
+                if (startScreenDirty || !pacer.WaitOnStaticScreens() || checkingAllocations) {
+                    // Clear the window to black
+                    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                    SDL_RenderClear(renderer);
 
-                // Render the start screen message
-                SDL_Color white = { 255, 255, 255, 255 };
-                RenderText(renderer, messageFont, "Press SPACE to start the game", white,  WINDOW_WIDTH / 2.8, WINDOW_HEIGHT / 2 - 20);
-                RenderText(renderer, messageFont, "Press ESC to exit the game", white, WINDOW_WIDTH / 2.7, WINDOW_HEIGHT / 2 + 20);
+                    // Render the start screen message
+                    SDL_Color white = { 255, 255, 255, 255 };
+                    messageAtlas.DrawText("Press SPACE to start the game", WINDOW_WIDTH / 2.8, WINDOW_HEIGHT / 2 - 20, white);
+                    messageAtlas.DrawText("Press ESC to exit the game", WINDOW_WIDTH / 2.7, WINDOW_HEIGHT / 2 + 20, white);
 
-                SDL_RenderPresent(renderer);
+                    Present(window, renderer, surfaceRendering);
+                    startScreenDirty = false;
+                }
+                
+                // Spectators see the host waiting here rather than a stream that stopped
+                simulation.ShowStartScreen();
+                
+                /*
+                * Sleep until the next event arrives instead of spinning on an unchanged screen
+                *   - Passing NULL leaves the event in the queue for the SDL_PollEvent loop above
+                */
+                if (pacer.WaitOnStaticScreens() && !checkingAllocations) {
+                    SDL_WaitEventTimeout(nullptr, STATIC_SCREEN_TIMEOUT_MS);
+                }
+                
+                if (checkingAllocations && ++startScreenFrames > AllocationCheck::WARMUP_FRAMES + START_SCREEN_CHECK_FRAMES) {
+                    startPlaying();
+                }
+                
+                // Nothing is simulated on the start screen, so don't let time build up
+                accumulator = 0.0f;
+                fullRedraw = true;
                 continue;
             }
             
 			else if (gameState == PLAYING){
+    			// Everything the steps since the last frame produced, the sounds start together
+    			unsigned frameEvents = pong::EVENT_NONE;
+    			
+    			// The state to draw, and how far past its step to draw it
+    			Snapshot const* view;
+    			float alpha;
+    			
+    			if(threaded){
+    			    frameEvents = simulationThread.TakeEvents();
+    			    if(simulationThread.Finished()){
+    			        running = false;
+    			    }
+    			    
+    			    view = &simulationThread.Latest();
+    			    float sinceStep = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - view->stepTime).count();
+    			    alpha = std::min(std::max(sinceStep / FIXED_DT, 0.0f), 1.0f);
+    			}else{
+    			    /*
+    			    * Run as many fixed steps as the elapsed time allows
+    			    *   - Any leftover time stays in the accumulator for the next frame
+    			    *   - A frame that would need more than MAX_STEPS_PER_FRAME steps drops the excess
+    			    */
+    			    accumulator += video.IsOpen() ? videoFrameMs : frameTime;
+    			    int steps = 0;
+    			    
+    			    simulation.Poll();
+    			    while(accumulator >= FIXED_DT && steps < MAX_STEPS_PER_FRAME){
+    			        // This step ends where the time left in the accumulator after it begins
+    			        auto due = currentTime - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+    			            std::chrono::duration<float, std::milli>(accumulator - FIXED_DT));
+    			        if(!simulation.Step(due, &profiler)){
+    			            running = false;
+    			            break;
+    			        }
+    			        frameEvents |= simulation.Match().events;
+    			        accumulator -= FIXED_DT;
+    			        ++steps;
+    			    }
+    			    if(steps == MAX_STEPS_PER_FRAME && accumulator >= FIXED_DT){
+    			        accumulator = 0.0f;
+    			    }
+    			    
+    			    simulation.Capture(localSnapshot);
+    			    view = &localSnapshot;
+    			    
+    			    // How far between the last two simulation steps this frame should be drawn
+    			    alpha = accumulator / FIXED_DT;
+    			}
+    			pong::GameState const& match = view->match;
+    			
     			/*
-    			* Adjust the paddle speed according to the button pressed
-    			*   - If the up button is pressed, it's velocity is set to -PADDLE_SPEED
-    			*   - If the down button is pressed, it's velocity is set to PADDLE_SPEED
-    			*   - If no button is pressed, it's velocity is set to 0
-    		    */
-    			if(buttons[Buttons::PaddleLeftUp]){
-    			    paddleLeft.velocity.y = -PADDLE_SPEED;
-    			} else if(buttons[Buttons::PaddleLeftDown]){
-    			    paddleLeft.velocity.y = PADDLE_SPEED;
-    			} else{
-    			    paddleLeft.velocity.y = 0.0f;
+    			* Play the hit sounds for whatever happened this frame
+    			*   - All steps of a frame reach the mixer in the same audio buffer anyway,
+    			*     so several hits of one kind in a frame are played once
+    			*/
+    			if(frameEvents & pong::EVENT_PADDLE_HIT){
+    			    sounds.Play(Sound::PaddleHit);
+    			}
+    			if(frameEvents & pong::EVENT_WALL_HIT){
+    			    sounds.Play(Sound::WallHit);
     			}
     			
-    			if(buttons[Buttons::PaddleRightUp]){
-    			    paddleRight.velocity.y = -PADDLE_SPEED;
-    			} else if(buttons[Buttons::PaddleRightDown]){
-    			    paddleRight.velocity.y = PADDLE_SPEED;
-    			} else{
-    			    paddleRight.velocity.y = 0.0f;
+    			/*
+    			* Refresh the score text only when it changed
+    			*   - The old and the new text are both redrawn when drawing only what changed
+    			*/
+    			dirty.Clear();
+    			if(match.leftScore != shownLeftScore){
+    			    SDL_Rect before = playerLeftScore.rect;
+    			    shownLeftScore = match.leftScore;
+    			    playerLeftScore.setScore(shownLeftScore);
+    			    dirty.AddMove(before, playerLeftScore.rect);
+    			}
+    			if(match.rightScore != shownRightScore){
+    			    SDL_Rect before = playerRightScore.rect;
+    			    shownRightScore = match.rightScore;
+    			    playerRightScore.setScore(shownRightScore);
+    			    dirty.AddMove(before, playerRightScore.rect);
     			}
-    		
-    			// Update the paddle positions
-    			paddleRight.update(dt);
-    			paddleLeft.update(dt);
     			
-    			// Update the ball position
-    			ball.update(dt);
+    			/*
+    			* Collecting the Net, the Ball and the Paddles
+    			*    - They are all white, so they are collected and drawn with one call
+    			*/
+    			profiler.Begin(Phase::Playfield);
+    			drawList.Clear();
+    			drawList.AddRects(netRects);
+    			SDL_Rect ballRect = {0, 0, 0, 0};
+    			if(!view->arenaBalls.empty()){
+    			    for(pong::Ball const& ball : view->arenaBalls){
+    			        drawList.AddRect(BallRect(ball, alpha));
+    			    }
+    			}else{
+    			    ballRect = BallRect(match.ball, alpha);
+    			    drawList.AddRect(ballRect);
+    			}
+    			SDL_Rect leftPaddleRect = PaddleRect(match.paddleLeft, alpha);
+    			SDL_Rect rightPaddleRect = PaddleRect(match.paddleRight, alpha);
+    			drawList.AddRect(leftPaddleRect);
+    			drawList.AddRect(rightPaddleRect);
+    			profiler.End(Phase::Playfield);
     			
-    			// If ball is colliding with the paddle, reverse the velocity of the ball
-    			if(Contact contact = CheckPaddleCollision(ball, paddleLeft); contact.type != CollisionType::None){
-    			    ball.CollideWithPaddle(contact);
-    				
-    				// Play the paddle hit sound
-    				Mix_PlayChannel(-1, paddleHitSound, 0);
-    			}else if(contact = CheckPaddleCollision(ball, paddleRight); contact.type != CollisionType::None){
-                    ball.CollideWithPaddle(contact);
-                    
-                    // Play the paddle hit sound
-                    Mix_PlayChannel(-1, paddleHitSound, 0);
-                }else if(contact = CheckWallCollision(ball); contact.type != CollisionType::None){
-                    ball.CollideWithWall(contact);
-                    
-                    /*
-                    * - If the ball collides with the left wall then the right player scores
-                    * - If the ball collides with the right wall then the left player scores
-                    */
-                    if(contact.type == CollisionType::Left){
-                        ++rightPlayerScore;
-                        playerRightScore.setScore(rightPlayerScore);
-                    }else if(contact.type == CollisionType::Right){
-                        ++leftPlayerScore;
-                        playerLeftScore.setScore(leftPlayerScore);
-                    }else{
-                        
-                        // Play the wall hit sound
-                        Mix_PlayChannel(-1, wallHitSound, 0);
-                    }
-                }
+    			/*
+    			* What to redraw
+    			*   - The GPU redraws the whole frame, a partial redraw wouldn't save it anything
+    			*   - Drawing into the window surface only redraws what changed since the last frame:
+    			*     where the ball and the paddles were and are now, and a changed score
+    			*   - Arena balls, text over the playfield and the first frame after something else
+    			*     was shown redraw everything
+    			*/
+    			if(!surfaceRendering || fullRedraw || !view->arenaBalls.empty() || view->waitingForPeer || profiler.OverlayVisible()){
+    			    dirty.MarkFull();
+    			}
+    			dirty.AddMove(drawnBall, ballRect);
+    			dirty.AddMove(drawnLeftPaddle, leftPaddleRect);
+    			dirty.AddMove(drawnRightPaddle, rightPaddleRect);
     			
-    			// Clear the window to black
-    			SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0xFF);
-    			SDL_RenderClear(renderer);
+    			if(videoTarget){
+    			    SDL_SetRenderTarget(renderer, videoTarget);
+    			}
     			
-    			// Setting the renderer colour to white 
-    			SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    			// One pass over the whole window, or one per dirty rect clipped to it
+    			int passes = dirty.Full() ? 1 : dirty.Count();
+    			for(int pass = 0; pass < passes; ++pass){
+    			    // Clear the window to black, SDL_RenderClear ignores the clip rect so a dirty rect is filled instead
+    			    profiler.Begin(Phase::Clear);
+    			    SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0xFF);
+    			    if(dirty.Full()){
+    			        SDL_RenderClear(renderer);
+    			    }else{
+    			        SDL_RenderSetClipRect(renderer, &dirty.Rects()[pass]);
+    			        SDL_RenderFillRect(renderer, &dirty.Rects()[pass]);
+    			    }
+    			    profiler.End(Phase::Clear);
+    			    
+    			    // Setting the renderer colour to white 
+    			    profiler.Begin(Phase::Playfield);
+    			    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    			    drawList.Submit(renderer);
+    			    profiler.End(Phase::Playfield);
+    			    
+    			    /*
+    			    * Drawing the Player Scores, both in one batch from the score atlas
+    			    */
+    			    profiler.Begin(Phase::Scores);
+    			    playerLeftScore.Draw();
+    			    playerRightScore.Draw();
+    			    scoreAtlas.Flush();
+    			    profiler.End(Phase::Scores);
+    			}
+    			if(!dirty.Full()){
+    			    SDL_RenderSetClipRect(renderer, nullptr);
+    			}
     			
-    			/*
-    			* Drawing the Net
-    			*    - y%5 is used to draw the dotted line
-    			*/
-    			for(int y = 0 ; y < WINDOW_HEIGHT ; ++y ){
-    			    if(y%5)
-    		          SDL_RenderDrawPoint(renderer,WINDOW_WIDTH/2, y);
+    			// Queue the frame for the video, then show it in the window, where the overlay goes on top
+    			if(videoTarget){
+    			    profiler.Begin(Phase::Capture);
+    			    if(!video.Capture(renderer)){
+    			        SDL_Log("Failed to read back a video frame: %s", SDL_GetError());
+    			        running = false;
+    			    }
+    			    SDL_SetRenderTarget(renderer, nullptr);
+    			    SDL_RenderCopy(renderer, videoTarget, nullptr, nullptr);
+    			    profiler.End(Phase::Capture);
     			}
     			
-    			/* 
-    			* Drawing the Ball
-    		    */
-    			ball.Draw(renderer);
+    			if(view->waitingForPeer){
+    			    SDL_Color white = { 255, 255, 255, 255 };
+    			    messageAtlas.DrawText(options.hostPort != 0 ? "Waiting for the other player to connect" : "Connecting...",
+    			                          WINDOW_WIDTH / 3.2, WINDOW_HEIGHT / 2 + 60, white);
+    			}
+    			
+    			// Frame statistics, toggled with F1
+    			if(profiler.OverlayVisible()){
+    			    profiler.Begin(Phase::Overlay);
+    			    profiler.DrawOverlay(messageAtlas, 10, 10);
+    			    profiler.End(Phase::Overlay);
+    			}
     			
-    			/*
-    			* Drawing the Paddles
-    		    */
-    		    paddleLeft.Draw(renderer);
-    		    paddleRight.Draw(renderer);
-    						
-    			/*
-    			* Drawing the Player Scores
-    		    */			
-    			playerLeftScore.Draw();
-    			playerRightScore.Draw();
-    		
     			/* Present the backbuffer
     			* SDL_RENDERPresent() Updates the screen with any rendering performed since the previous call.
-                *
-                * SDL's rendering functions operate on a backbuffer; that is, calling a
-                * rendering function such as SDL_RenderDrawLine() does not directly put a
-                * line on the screen, but rather updates the backbuffer. 
-                *
-                * Commonly in graphics, you render to a buffer that is not on screen (i.e., the backbuffer), 
-                * and then when ready you swap it with the buffer currently on screen and the frontbuffer 
-                * becomes the backbuffer.F
-                */
-    			SDL_RenderPresent(renderer);
+    			*
+    			* SDL's rendering functions operate on a backbuffer; that is, calling a
+    			* rendering function such as SDL_RenderDrawLine() does not directly put a
+    			* line on the screen, but rather updates the backbuffer. 
+    			*
+    			* Commonly in graphics, you render to a buffer that is not on screen (i.e., the backbuffer), 
+    			* and then when ready you swap it with the buffer currently on screen and the frontbuffer 
+    			* becomes the backbuffer.F
+    			*/
+    			profiler.Begin(Phase::Present);
+    			auto inputTime = view->lastInputTime;
+    			Present(window, renderer, surfaceRendering, &dirty);
+    			profiler.End(Phase::Present);
+    			
+    			// What is on screen now, for the next frame's dirty rects
+    			drawnBall = ballRect;
+    			drawnLeftPaddle = leftPaddleRect;
+    			drawnRightPaddle = rightPaddleRect;
+    			fullRedraw = view->waitingForPeer || profiler.OverlayVisible();
+    			
+    			// The first frame showing a new key change measures how long it took to get on screen
+    			if(inputTime > lastMeasuredInput){
+    			    profiler.AddInputLatency(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - inputTime).count());
+    			    lastMeasuredInput = inputTime;
+    			}
+    			
+    			// Wait for the next frame when limiting the frame rate
+    			pacer.EndFrame();
+    			profiler.EndFrame();
 			}
-			
-			// Calculate the time taken to render the frame at the end 
-			auto stopTime = std::chrono::high_resolution_clock::now();
-			
-			// Calculates the difference between the start and stop times in milliseconds
-			dt = std::chrono::duration<float, std::chrono::milliseconds::period>(stopTime - startTime).count();
+		}
+		
+		simulationThread.Stop();
+		simulation.Finish();
+		
+		// Writes out the frames still queued
+		if(video.IsOpen()){
+		    if(video.Close()){
+		        SDL_Log("Recorded %llu video frames to %s", static_cast<unsigned long long>(video.FramesWritten()), options.videoPath);
+		    }else{
+		        SDL_Log("Failed to write video file: %s", options.videoPath);
+		    }
+		}
+		if(videoTarget){
+		    SDL_DestroyTexture(videoTarget);
+		}
+		
+		if(profiler.InputLatencyCount() > 0){
+		    SDL_Log("Input to present latency: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms",
+		            profiler.InputLatencyPercentile(50.0f), profiler.InputLatencyPercentile(95.0f), profiler.InputLatencyPercentile(99.0f));
+		}
+		
+		if(checkingAllocations){
+		    SDL_Log("Allocation check: %llu of %d frames allocated, %llu SDL allocations served by the frame arena",
+		            static_cast<unsigned long long>(allocationCheck.FailedFrames()), options.allocationCheckFrames,
+		            static_cast<unsigned long long>(ArenaAllocations()));
+		    if(!allocationCheck.Done()){
+		        SDL_Log("Allocation check: the game ended before every frame was checked");
+		    }
+		    if(allocationCheck.FailedFrames() > 0 || !allocationCheck.Done()){
+		        exitCode = 1;
+		    }
 		}
 	}
 
 	// Cleanup
-	Mix_FreeChunk(wallHitSound);
-	Mix_FreeChunk(paddleHitSound);
+	sounds.Close();
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	TTF_CloseFont(scoreFont);
+	TTF_CloseFont(messageFont);
 	TTF_Quit();
 	SDL_Quit();
-	return 0;
+	return exitCode;
 }
@@ -0,0 +1,49 @@
+#include "net/link_conditioner.h"
+
+#include <cstring>
+
+namespace pong {
+
+LinkConditioner::LinkConditioner(LinkConditions const& conditions) : conditions(conditions), random(conditions.seed){
+    pending.reserve(256);
+}
+
+void LinkConditioner::Send(UdpSocket& socket, NetAddress const& to, const void* data, std::size_t size, double nowMs){
+    if(conditions.lossPercent > 0.0 && std::uniform_real_distribution<double>(0.0, 100.0)(random) < conditions.lossPercent){
+        return;
+    }
+    
+    double delay = conditions.delayMs;
+    if(conditions.jitterMs > 0.0){
+        delay += std::uniform_real_distribution<double>(-conditions.jitterMs, conditions.jitterMs)(random);
+    }
+    if(delay <= 0.0 || size > MAX_PACKET){
+        socket.SendTo(to, data, size);
+        return;
+    }
+    
+    pending.emplace_back();
+    Pending& packet = pending.back();
+    packet.dueMs = nowMs + delay;
+    packet.to = to;
+    packet.size = size;
+    std::memcpy(packet.data, data, size);
+}
+
+void LinkConditioner::Pump(UdpSocket& socket, double nowMs){
+    // Send and remove due packets, keeping the rest in place
+    std::size_t kept = 0;
+    for(std::size_t i = 0; i < pending.size(); ++i){
+        if(pending[i].dueMs <= nowMs){
+            socket.SendTo(pending[i].to, pending[i].data, pending[i].size);
+        }else{
+            if(kept != i){
+                pending[kept] = pending[i];
+            }
+            ++kept;
+        }
+    }
+    pending.resize(kept);
+}
+
+} // namespace pong
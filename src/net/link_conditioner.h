@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "net/udp_socket.h"
+
+namespace pong {
+
+// Network conditions to simulate on outgoing packets
+struct LinkConditions{
+    double delayMs = 0.0;
+    double jitterMs = 0.0;
+    double lossPercent = 0.0;
+    uint32_t seed = 1;
+};
+
+/*
+* Delays, reorders (through jitter) and drops outgoing datagrams
+*   - With every condition at zero, packets are sent straight away
+*   - Packets waiting for their send time live in preallocated slots
+*/
+class LinkConditioner{
+    public:
+        static const std::size_t MAX_PACKET = 512;
+        
+        explicit LinkConditioner(LinkConditions const& conditions = LinkConditions());
+        
+        void Send(UdpSocket& socket, NetAddress const& to, const void* data, std::size_t size, double nowMs);
+        
+        // Sends every delayed packet whose time has come
+        void Pump(UdpSocket& socket, double nowMs);
+        
+    private:
+        struct Pending{
+            double dueMs;
+            NetAddress to;
+            std::size_t size;
+            uint8_t data[MAX_PACKET];
+        };
+        
+        LinkConditions conditions;
+        std::mt19937 random;
+        std::vector<Pending> pending;
+};
+
+} // namespace pong
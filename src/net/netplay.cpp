@@ -0,0 +1,178 @@
+#include "net/netplay.h"
+
+namespace pong {
+
+static const uint8_t PACKET_MAGIC[2] = {'P', 'N'};
+static const uint8_t PACKET_HELLO = 1;
+static const uint8_t PACKET_INPUTS = 2;
+
+// magic, type, frame, ack, advantage, first input step, input count
+static const std::size_t INPUT_HEADER_SIZE = 2 + 1 + 4 + 4 + 4 + 4 + 1;
+
+// Hellos and keep-alive resends go out this often while nothing else is sent
+static const double RESEND_INTERVAL_MS = 16.0;
+
+// Only stall when this many steps ahead of the peer, so small clock noise is ignored
+static const int32_t MAX_FRAME_LEAD = 2;
+
+static void PutU32(uint8_t* out, uint32_t value){
+    for(int i = 0; i < 4; ++i){
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint32_t GetU32(const uint8_t* in){
+    uint32_t value = 0;
+    for(int i = 0; i < 4; ++i){
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+Netplay::Netplay(NetplayConfig const& config)
+    : config(config), conditioner(config.conditions), session(config.host ? 0 : 1, NewGame(), config.mode){
+}
+
+bool Netplay::Start(){
+    if(!socket.Open(config.localPort)){
+        return false;
+    }
+    if(!config.host){
+        return config.remoteHost && ResolveAddress(config.remoteHost, config.remotePort, peer);
+    }
+    return true;
+}
+
+void Netplay::Send(const uint8_t* data, std::size_t size, double nowMs){
+    conditioner.Send(socket, peer, data, size, nowMs);
+    lastSendMs = nowMs;
+    ++stats.packetsSent;
+}
+
+void Netplay::SendHello(double nowMs){
+    uint8_t packet[3] = {PACKET_MAGIC[0], PACKET_MAGIC[1], PACKET_HELLO};
+    Send(packet, sizeof(packet), nowMs);
+}
+
+void Netplay::SendInputs(double nowMs){
+    // Everything simulated that the peer hasn't confirmed, as far back as the window reaches
+    uint32_t frame = session.Frame();
+    uint32_t first = peerAck;
+    if(frame > static_cast<uint32_t>(ROLLBACK_WINDOW) && first < frame - ROLLBACK_WINDOW){
+        first = frame - ROLLBACK_WINDOW;
+    }
+    if(first > frame){
+        first = frame;
+    }
+    uint32_t count = frame - first;
+    
+    uint8_t packet[INPUT_HEADER_SIZE + ROLLBACK_WINDOW];
+    packet[0] = PACKET_MAGIC[0];
+    packet[1] = PACKET_MAGIC[1];
+    packet[2] = PACKET_INPUTS;
+    PutU32(packet + 3, frame);
+    PutU32(packet + 7, session.ConfirmedFrame());
+    PutU32(packet + 11, static_cast<uint32_t>(static_cast<int32_t>(frame - peerFrame)));
+    PutU32(packet + 15, first);
+    packet[19] = static_cast<uint8_t>(count);
+    for(uint32_t i = 0; i < count; ++i){
+        packet[INPUT_HEADER_SIZE + i] = session.LocalInput(first + i);
+    }
+    Send(packet, INPUT_HEADER_SIZE + count, nowMs);
+}
+
+void Netplay::Handle(const uint8_t* data, std::size_t size, NetAddress const& from, double nowMs){
+    if(size < 3 || data[0] != PACKET_MAGIC[0] || data[1] != PACKET_MAGIC[1]){
+        return;
+    }
+    
+    // The host takes the first peer that says hello, everyone else is ignored
+    if(!connected){
+        if(config.host){
+            peer = from;
+        }else if(from != peer){
+            return;
+        }
+        connected = true;
+    }else if(from != peer){
+        return;
+    }
+    ++stats.packetsReceived;
+    
+    if(data[2] == PACKET_HELLO){
+        if(config.host){
+            SendHello(nowMs);
+        }
+        return;
+    }
+    
+    if(data[2] != PACKET_INPUTS || size < INPUT_HEADER_SIZE){
+        return;
+    }
+    
+    uint32_t frame = GetU32(data + 3);
+    uint32_t ack = GetU32(data + 7);
+    int32_t advantage = static_cast<int32_t>(GetU32(data + 11));
+    uint32_t first = GetU32(data + 15);
+    uint32_t count = data[19];
+    if(size < INPUT_HEADER_SIZE + count){
+        return;
+    }
+    
+    // Packets may arrive out of order, only newer information counts
+    if(frame >= peerFrame){
+        peerFrame = frame;
+        peerAdvantage = advantage;
+    }
+    if(ack > peerAck){
+        peerAck = ack;
+    }
+    for(uint32_t i = 0; i < count; ++i){
+        session.AddRemoteInput(first + i, data[INPUT_HEADER_SIZE + i] & 0x3u);
+    }
+}
+
+void Netplay::Poll(double nowMs){
+    conditioner.Pump(socket, nowMs);
+    
+    uint8_t buffer[LinkConditioner::MAX_PACKET];
+    NetAddress from;
+    while(std::size_t size = socket.Receive(buffer, sizeof(buffer), from)){
+        Handle(buffer, size, from, nowMs);
+    }
+    
+    // Correct mispredictions right away rather than on the next step, so the frame drawn is right
+    session.Resolve();
+    
+    if(nowMs - lastSendMs >= RESEND_INTERVAL_MS){
+        if(!connected){
+            if(!config.host){
+                SendHello(nowMs);
+            }
+        }else{
+            SendInputs(nowMs);
+        }
+    }
+}
+
+bool Netplay::ShouldWait() const{
+    /*
+    * Both sides see the other's frame one trip late, so each thinks it leads by the
+    * latency. Half the difference of the two leads is how far this side is really ahead.
+    */
+    int32_t localAdvantage = static_cast<int32_t>(session.Frame() - peerFrame);
+    return (localAdvantage - peerAdvantage) / 2 > MAX_FRAME_LEAD;
+}
+
+bool Netplay::Step(PlayerInput local, double nowMs){
+    if(!connected || !session.CanAdvance() || ShouldWait()){
+        ++stats.stalledSteps;
+        return false;
+    }
+    
+    session.Advance(local);
+    SendInputs(nowMs);
+    return true;
+}
+
+} // namespace pong
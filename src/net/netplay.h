@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/rollback.h"
+#include "net/link_conditioner.h"
+#include "net/udp_socket.h"
+
+namespace pong {
+
+struct NetplayConfig{
+    // The host plays the left paddle and waits for the client, which plays the right paddle
+    bool host = true;
+    uint16_t localPort = 0;
+    
+    // Where the client finds the host
+    const char* remoteHost = nullptr;
+    uint16_t remotePort = 0;
+    
+    LinkConditions conditions;
+    CollisionMode mode = CollisionMode::Discrete;
+};
+
+struct NetplayStats{
+    uint64_t packetsSent = 0;
+    uint64_t packetsReceived = 0;
+    uint64_t stalledSteps = 0;
+};
+
+/*
+* Two-player match over UDP with rollback
+*   - Every packet carries all local inputs the peer hasn't acknowledged yet,
+*     so a lost packet is covered by the next one without retransmission
+*   - Steps never wait for the network; they only stall when this side gets too far
+*     ahead of the peer (to keep both clocks together) or would leave the rollback window
+*/
+class Netplay{
+    public:
+        explicit Netplay(NetplayConfig const& config);
+        
+        // Opens the socket (and resolves the host for a client)
+        bool Start();
+        
+        // Sends due packets, handles everything received and rolls back if needed, call at least once per frame
+        void Poll(double nowMs);
+        
+        bool Connected() const { return connected; }
+        
+        // Simulates the next step with the local player's input, false if it has to wait
+        bool Step(PlayerInput local, double nowMs);
+        
+        // Events of the steps simulated and corrected since the last call, see RollbackSession::TakeEvents()
+        unsigned TakeEvents() { return session.TakeEvents(); }
+        
+        int LocalPlayer() const { return config.host ? 0 : 1; }
+        uint16_t LocalPort() const { return socket.LocalPort(); }
+        
+        GameState const& State() const { return session.State(); }
+        RollbackSession const& Session() const { return session; }
+        NetplayStats const& Stats() const { return stats; }
+        
+    private:
+        void Send(const uint8_t* data, std::size_t size, double nowMs);
+        void SendHello(double nowMs);
+        void SendInputs(double nowMs);
+        void Handle(const uint8_t* data, std::size_t size, NetAddress const& from, double nowMs);
+        bool ShouldWait() const;
+        
+        NetplayConfig config;
+        UdpSocket socket;
+        LinkConditioner conditioner;
+        RollbackSession session;
+        NetplayStats stats;
+        
+        NetAddress peer;
+        bool connected = false;
+        double lastSendMs = -1.0e9;
+        
+        // What the peer last told us
+        uint32_t peerAck = 0;
+        uint32_t peerFrame = 0;
+        int32_t peerAdvantage = 0;
+};
+
+} // namespace pong
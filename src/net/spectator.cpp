@@ -0,0 +1,490 @@
+#include "net/spectator.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "net/udp_socket.h"
+
+namespace pong {
+
+static const float POSITION_SCALE = 16.0f;
+static const float VELOCITY_SCALE = 4096.0f;
+
+static const uint8_t MESSAGE_KEYFRAME = 'K';
+static const uint8_t MESSAGE_DELTA = 'D';
+
+// Writing to a spectator that hung up must not raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+static const int SEND_FLAGS = MSG_DONTWAIT;
+#endif
+
+static const char UNIX_PREFIX[] = "unix:";
+
+static int32_t QuantizeValue(float value, float scale){
+    return static_cast<int32_t>(std::lround(value * scale));
+}
+
+SpectatorState Quantize(GameState const& state, uint32_t tick, SpectatorScreen screen){
+    SpectatorState quantized;
+    quantized.tick = tick;
+    int32_t* fields = quantized.fields;
+    fields[SpectatorState::BallX] = QuantizeValue(state.ball.position.x, POSITION_SCALE);
+    fields[SpectatorState::BallY] = QuantizeValue(state.ball.position.y, POSITION_SCALE);
+    fields[SpectatorState::BallVelocityX] = QuantizeValue(state.ball.velocity.x, VELOCITY_SCALE);
+    fields[SpectatorState::BallVelocityY] = QuantizeValue(state.ball.velocity.y, VELOCITY_SCALE);
+    fields[SpectatorState::LeftX] = QuantizeValue(state.paddleLeft.position.x, POSITION_SCALE);
+    fields[SpectatorState::LeftY] = QuantizeValue(state.paddleLeft.position.y, POSITION_SCALE);
+    fields[SpectatorState::LeftVelocityY] = QuantizeValue(state.paddleLeft.velocity.y, VELOCITY_SCALE);
+    fields[SpectatorState::RightX] = QuantizeValue(state.paddleRight.position.x, POSITION_SCALE);
+    fields[SpectatorState::RightY] = QuantizeValue(state.paddleRight.position.y, POSITION_SCALE);
+    fields[SpectatorState::RightVelocityY] = QuantizeValue(state.paddleRight.velocity.y, VELOCITY_SCALE);
+    fields[SpectatorState::LeftScore] = state.leftScore;
+    fields[SpectatorState::RightScore] = state.rightScore;
+    fields[SpectatorState::Events] = static_cast<int32_t>(state.events);
+    fields[SpectatorState::Screen] = screen;
+    return quantized;
+}
+
+GameState Dequantize(SpectatorState const& state){
+    const int32_t* fields = state.fields;
+    GameState result;
+    result.ball.position = Vec2(fields[SpectatorState::BallX] / POSITION_SCALE, fields[SpectatorState::BallY] / POSITION_SCALE);
+    result.ball.previousPosition = result.ball.position;
+    result.ball.velocity = Vec2(fields[SpectatorState::BallVelocityX] / VELOCITY_SCALE, fields[SpectatorState::BallVelocityY] / VELOCITY_SCALE);
+    result.paddleLeft.position = Vec2(fields[SpectatorState::LeftX] / POSITION_SCALE, fields[SpectatorState::LeftY] / POSITION_SCALE);
+    result.paddleLeft.previousPosition = result.paddleLeft.position;
+    result.paddleLeft.velocity = Vec2(0.0f, fields[SpectatorState::LeftVelocityY] / VELOCITY_SCALE);
+    result.paddleRight.position = Vec2(fields[SpectatorState::RightX] / POSITION_SCALE, fields[SpectatorState::RightY] / POSITION_SCALE);
+    result.paddleRight.previousPosition = result.paddleRight.position;
+    result.paddleRight.velocity = Vec2(0.0f, fields[SpectatorState::RightVelocityY] / VELOCITY_SCALE);
+    result.leftScore = fields[SpectatorState::LeftScore];
+    result.rightScore = fields[SpectatorState::RightScore];
+    result.events = static_cast<unsigned>(fields[SpectatorState::Events]);
+    return result;
+}
+
+static std::size_t PutVarint(uint8_t* out, int32_t value){
+    // Zigzag, so small negative numbers are short too
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    std::size_t size = 0;
+    while(zigzag >= 0x80){
+        out[size++] = static_cast<uint8_t>(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(zigzag);
+    return size;
+}
+
+static bool GetVarint(const uint8_t*& in, const uint8_t* end, int32_t& value){
+    uint32_t zigzag = 0;
+    for(int shift = 0; shift < 35; shift += 7){
+        if(in == end){
+            return false;
+        }
+        uint8_t byte = *in++;
+        zigzag |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if((byte & 0x80) == 0){
+            value = static_cast<int32_t>((zigzag >> 1) ^ (0u - (zigzag & 1)));
+            return true;
+        }
+    }
+    return false;
+}
+
+static void PutU32(uint8_t* out, uint32_t value){
+    for(int i = 0; i < 4; ++i){
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint32_t GetU32(const uint8_t* in){
+    uint32_t value = 0;
+    for(int i = 0; i < 4; ++i){
+        value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+std::size_t EncodeKeyframe(SpectatorState const& state, uint8_t* out){
+    std::size_t size = 1;
+    out[size++] = MESSAGE_KEYFRAME;
+    PutU32(out + size, state.tick);
+    size += 4;
+    for(int field = 0; field < SpectatorState::FieldCount; ++field){
+        size += PutVarint(out + size, state.fields[field]);
+    }
+    out[0] = static_cast<uint8_t>(size - 1);
+    return size;
+}
+
+std::size_t EncodeDelta(SpectatorState const& keyframe, SpectatorState const& state, uint8_t* out){
+    std::size_t size = 1;
+    out[size++] = MESSAGE_DELTA;
+    PutU32(out + size, state.tick);
+    size += 4;
+    
+    // The mask goes in front of the values, it is known once they are written
+    std::size_t maskAt = size;
+    size += 2;
+    uint16_t mask = 0;
+    for(int field = 0; field < SpectatorState::FieldCount; ++field){
+        int32_t difference = state.fields[field] - keyframe.fields[field];
+        if(difference != 0){
+            mask |= static_cast<uint16_t>(1u << field);
+            size += PutVarint(out + size, difference);
+        }
+    }
+    out[maskAt] = static_cast<uint8_t>(mask);
+    out[maskAt + 1] = static_cast<uint8_t>(mask >> 8);
+    out[0] = static_cast<uint8_t>(size - 1);
+    return size;
+}
+
+bool SpectatorDecoder::Decode(const uint8_t* message, std::size_t size, SpectatorState& state){
+    const uint8_t* end = message + size;
+    if(size < 5){
+        return false;
+    }
+    uint8_t type = message[0];
+    uint32_t tick = GetU32(message + 1);
+    const uint8_t* in = message + 5;
+    
+    if(type == MESSAGE_KEYFRAME){
+        SpectatorState decoded;
+        decoded.tick = tick;
+        for(int field = 0; field < SpectatorState::FieldCount; ++field){
+            if(!GetVarint(in, end, decoded.fields[field])){
+                return false;
+            }
+        }
+        keyframe = decoded;
+        haveKeyframe = true;
+        state = decoded;
+        return true;
+    }
+    
+    if(type != MESSAGE_DELTA || !haveKeyframe || end - in < 2){
+        return false;
+    }
+    uint16_t mask = static_cast<uint16_t>(in[0] | (in[1] << 8));
+    in += 2;
+    SpectatorState decoded = keyframe;
+    decoded.tick = tick;
+    for(int field = 0; field < SpectatorState::FieldCount; ++field){
+        int32_t difference;
+        if(mask & (1u << field)){
+            if(!GetVarint(in, end, difference)){
+                return false;
+            }
+            decoded.fields[field] += difference;
+        }
+    }
+    state = decoded;
+    return true;
+}
+
+// "unix:PATH" fills `path` and returns true, anything else is left for TCP
+static bool UnixPath(const char* address, sockaddr_un& path){
+    std::size_t prefix = sizeof(UNIX_PREFIX) - 1;
+    if(std::strncmp(address, UNIX_PREFIX, prefix) != 0){
+        return false;
+    }
+    std::memset(&path, 0, sizeof(path));
+    path.sun_family = AF_UNIX;
+    std::strncpy(path.sun_path, address + prefix, sizeof(path.sun_path) - 1);
+    return true;
+}
+
+SpectatorServer::~SpectatorServer(){
+    Close();
+}
+
+bool SpectatorServer::Open(const char* address){
+    Close();
+    
+    sockaddr_un local;
+    if(UnixPath(address, local)){
+        // A socket file left behind by an earlier run would make bind fail
+        unixPath = local.sun_path;
+        unlink(local.sun_path);
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listener >= 0 && bind(listener, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0){
+            close(listener);
+            listener = -1;
+        }
+    }else{
+        int port = std::atoi(address);
+        if(port <= 0 || port > 65535){
+            return false;
+        }
+        sockaddr_in any;
+        std::memset(&any, 0, sizeof(any));
+        any.sin_family = AF_INET;
+        any.sin_addr.s_addr = htonl(INADDR_ANY);
+        any.sin_port = htons(static_cast<uint16_t>(port));
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        if(listener >= 0 && (setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                             bind(listener, reinterpret_cast<sockaddr*>(&any), sizeof(any)) != 0)){
+            close(listener);
+            listener = -1;
+        }
+    }
+    if(listener < 0 || listen(listener, 16) != 0 || fcntl(listener, F_SETFL, fcntl(listener, F_GETFL, 0) | O_NONBLOCK) != 0){
+        Close();
+        return false;
+    }
+    
+    // Room for plenty of spectators before the list ever grows
+    clients.reserve(64);
+    stats = SpectatorStats();
+    dropped = 0;
+    tick = 0;
+    hasKeyframe = false;
+    published.store(0);
+    consumed.store(0);
+    closing.store(false);
+    server = std::thread(&SpectatorServer::Run, this);
+    return true;
+}
+
+void SpectatorServer::Close(){
+    closing.store(true);
+    if(server.joinable()){
+        server.join();
+        stats.published = published.load();
+        stats.dropped = dropped;
+    }
+    for(Client const& client : clients){
+        close(client.fd);
+    }
+    clients.clear();
+    if(listener >= 0){
+        close(listener);
+        listener = -1;
+    }
+    if(!unixPath.empty()){
+        unlink(unixPath.c_str());
+        unixPath.clear();
+    }
+}
+
+void SpectatorServer::Publish(GameState const& state, SpectatorScreen screen){
+    /*
+    * A keyframe is due every KEYFRAME_INTERVAL ticks, and on the start screen every tick,
+    * which is only once a frame there. Deltas are only taken against a keyframe that made
+    * it into the ring; a keyframe that is dropped is retried next tick
+    */
+    SpectatorState quantized = Quantize(state, tick++, screen);
+    bool keyframeDue = !hasKeyframe || screen == SPECTATOR_START_SCREEN || quantized.tick - keyframe.tick >= KEYFRAME_INTERVAL;
+    
+    uint64_t index = published.load(std::memory_order_relaxed);
+    if(index - consumed.load(std::memory_order_acquire) >= RING_MESSAGES){
+        ++dropped;
+        return;
+    }
+    
+    Message& message = ring[index % RING_MESSAGES];
+    if(keyframeDue){
+        keyframe = quantized;
+        hasKeyframe = true;
+        message.size = static_cast<uint8_t>(EncodeKeyframe(quantized, message.bytes));
+    }else{
+        message.size = static_cast<uint8_t>(EncodeDelta(keyframe, quantized, message.bytes));
+    }
+    message.keyframe = keyframe.tick;
+    published.store(index + 1, std::memory_order_release);
+}
+
+void SpectatorServer::Accept(){
+    for(;;){
+        int fd = accept(listener, nullptr, nullptr);
+        if(fd < 0){
+            return;
+        }
+        
+        // Each message is sent as soon as it is published, no waiting to fill a segment
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+        int noSigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        
+        Client client;
+        client.fd = fd;
+        client.keyframe = 0;
+        client.hasKeyframe = false;
+        client.pendingBegin = 0;
+        client.pendingEnd = 0;
+        clients.push_back(client);
+        ++stats.clientsServed;
+    }
+}
+
+/*
+* Sends one message to one client, false if the client is gone
+*   - The rest of a message the socket only took part of goes out first; until it has,
+*     and while the client lacks the keyframe a message is against, messages are skipped
+*/
+bool SpectatorServer::Send(Client& client, Message const& message){
+    if(client.pendingBegin < client.pendingEnd){
+        ssize_t sent = send(client.fd, client.pending + client.pendingBegin, client.pendingEnd - client.pendingBegin, SEND_FLAGS);
+        if(sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK){
+            return false;
+        }
+        client.pendingBegin += sent > 0 ? static_cast<std::size_t>(sent) : 0;
+        stats.bytesSent += sent > 0 ? static_cast<uint64_t>(sent) : 0;
+        if(client.pendingBegin < client.pendingEnd){
+            ++stats.skipped;
+            return true;
+        }
+    }
+    
+    bool isKeyframe = message.bytes[1] == MESSAGE_KEYFRAME;
+    if(!isKeyframe && !(client.hasKeyframe && client.keyframe == message.keyframe)){
+        ++stats.skipped;
+        return true;
+    }
+    
+    ssize_t sent = send(client.fd, message.bytes, message.size, SEND_FLAGS);
+    if(sent < 0){
+        if(errno != EAGAIN && errno != EWOULDBLOCK){
+            return false;
+        }
+        
+        // Nothing went out, the stream is still whole; a missed keyframe means waiting for the next
+        ++stats.skipped;
+        if(isKeyframe){
+            client.hasKeyframe = false;
+        }
+        return true;
+    }
+    stats.bytesSent += static_cast<uint64_t>(sent);
+    ++stats.messagesSent;
+    if(static_cast<std::size_t>(sent) < message.size){
+        std::size_t rest = message.size - static_cast<std::size_t>(sent);
+        std::memcpy(client.pending, message.bytes + sent, rest);
+        client.pendingBegin = 0;
+        client.pendingEnd = rest;
+    }
+    if(isKeyframe){
+        client.keyframe = message.keyframe;
+        client.hasKeyframe = true;
+    }
+    return true;
+}
+
+void SpectatorServer::Run(){
+    uint64_t next = consumed.load(std::memory_order_relaxed);
+    
+    while(!closing.load(std::memory_order_acquire)){
+        Accept();
+        
+        // Every published message, encoded once, to every client
+        uint64_t available = published.load(std::memory_order_acquire);
+        for(; next < available; ++next){
+            Message const& message = ring[next % RING_MESSAGES];
+            for(std::size_t i = 0; i < clients.size();){
+                if(Send(clients[i], message)){
+                    ++i;
+                    continue;
+                }
+                close(clients[i].fd);
+                clients[i] = clients.back();
+                clients.pop_back();
+            }
+            consumed.store(next + 1, std::memory_order_release);
+        }
+        
+        // Sleep until a spectator connects, or a millisecond at most; a step is 4 ms
+        pollfd waiting{listener, POLLIN, 0};
+        poll(&waiting, 1, 1);
+    }
+}
+
+SpectatorClient::~SpectatorClient(){
+    Close();
+}
+
+bool SpectatorClient::Connect(const char* address){
+    Close();
+    
+    sockaddr_un path;
+    if(UnixPath(address, path)){
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&path), sizeof(path)) == 0){
+            return true;
+        }
+        Close();
+        return false;
+    }
+    
+    const char* colon = std::strrchr(address, ':');
+    NetAddress server;
+    std::string host = colon ? std::string(address, colon) : std::string("127.0.0.1");
+    int port = std::atoi(colon ? colon + 1 : address);
+    if(port <= 0 || port > 65535 || !ResolveAddress(host.c_str(), static_cast<uint16_t>(port), server)){
+        return false;
+    }
+    sockaddr_in remote;
+    std::memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_addr.s_addr = htonl(server.ip);
+    remote.sin_port = htons(server.port);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == 0){
+        return true;
+    }
+    Close();
+    return false;
+}
+
+void SpectatorClient::Close(){
+    if(fd >= 0){
+        close(fd);
+        fd = -1;
+    }
+    begin = 0;
+    end = 0;
+}
+
+bool SpectatorClient::Next(SpectatorState& state){
+    for(;;){
+        // A whole message in the buffer, decode it; skip what can't be decoded yet
+        while(end - begin >= 1 && end - begin >= 1u + buffer[begin]){
+            std::size_t size = buffer[begin];
+            const uint8_t* message = buffer + begin + 1;
+            begin += 1 + size;
+            if(decoder.Decode(message, size, state)){
+                return true;
+            }
+        }
+        
+        // Move the partial message to the front and read more
+        std::memmove(buffer, buffer + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        ssize_t received = fd >= 0 ? recv(fd, buffer + end, sizeof(buffer) - end, 0) : -1;
+        if(received <= 0){
+            return false;
+        }
+        end += static_cast<std::size_t>(received);
+        bytesReceived += static_cast<uint64_t>(received);
+    }
+}
+
+} // namespace pong
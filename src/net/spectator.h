@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/game.h"
+
+namespace pong {
+
+/*
+* Spectator stream, sent from the match host to any number of read-only clients
+* over TCP or a Unix socket
+*
+*   message   u8 length of the rest of the message, then the rest
+*   keyframe  'K', u32 tick, then every field as a zigzag varint
+*   delta     'D', u32 tick, u16 mask of the fields that differ from the last keyframe,
+*             then for each set bit (lowest first) the difference as a zigzag varint
+*
+* Positions are sent in 1/16 pixels and velocities in 1/4096 pixels per millisecond.
+* Every delta is against the last keyframe, not the previous message, so a client that
+* misses messages only needs that keyframe to decode the next one.
+*
+* The Screen field is a SpectatorScreen. While the host sits on its start screen it
+* publishes about once per frame instead of once per step, and every one of those
+* messages is a keyframe, so a spectator can tell a host waiting to start from one that
+* stalled, and one joining then doesn't wait long for its first state.
+*/
+
+// What the host is showing
+enum SpectatorScreen : int32_t {
+    SPECTATOR_START_SCREEN = 0,
+    SPECTATOR_PLAYING = 1
+};
+
+struct SpectatorState{
+    enum Field{
+        BallX,
+        BallY,
+        BallVelocityX,
+        BallVelocityY,
+        LeftX,
+        LeftY,
+        LeftVelocityY,
+        RightX,
+        RightY,
+        RightVelocityY,
+        LeftScore,
+        RightScore,
+        Events,
+        Screen,
+        FieldCount
+    };
+    
+    uint32_t tick = 0;
+    int32_t fields[FieldCount] = {};
+};
+
+// Longest message, a keyframe with every field at its longest varint
+const std::size_t MAX_SPECTATOR_MESSAGE = 1 + 1 + 4 + 5 * SpectatorState::FieldCount;
+
+SpectatorState Quantize(GameState const& state, uint32_t tick, SpectatorScreen screen = SPECTATOR_PLAYING);
+GameState Dequantize(SpectatorState const& state);
+
+// Write one whole message, length byte included, and return its size
+std::size_t EncodeKeyframe(SpectatorState const& state, uint8_t* out);
+std::size_t EncodeDelta(SpectatorState const& keyframe, SpectatorState const& state, uint8_t* out);
+
+/*
+* Turns messages back into states
+*   - Deltas before the first keyframe can't be decoded and are skipped
+*/
+class SpectatorDecoder{
+    public:
+        // `message` is what follows the length byte, false if it isn't a state that can be decoded
+        bool Decode(const uint8_t* message, std::size_t size, SpectatorState& state);
+        
+    private:
+        SpectatorState keyframe;
+        bool haveKeyframe = false;
+};
+
+// Counted by the server thread, read them after Close()
+struct SpectatorStats{
+    uint64_t published = 0;
+    uint64_t dropped = 0;
+    uint64_t clientsServed = 0;
+    uint64_t messagesSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t skipped = 0;
+};
+
+/*
+* Serves the match to spectators
+*   - Publish() is called once per simulation step, or once per frame on the start screen;
+*     it encodes the state once and hands the message to a server thread through a
+*     lock-free ring, it never blocks or does I/O
+*   - The server thread accepts clients and sends the same encoded message to each of
+*     them, with one non-blocking send per client and message
+*   - A client whose socket is full isn't queued for: it skips messages, and if it missed
+*     a keyframe it waits for the next one, so a slow client costs nothing and catches up
+*   - If the server thread itself falls behind, Publish() drops messages the same way
+*/
+class SpectatorServer{
+    public:
+        static const int RING_MESSAGES = 64;
+        
+        // A keyframe every half second at the 240 Hz step rate
+        static const uint32_t KEYFRAME_INTERVAL = 120;
+        
+        SpectatorServer() = default;
+        ~SpectatorServer();
+        
+        SpectatorServer(SpectatorServer const&) = delete;
+        SpectatorServer& operator=(SpectatorServer const&) = delete;
+        
+        // Listens on "PORT" (TCP, all interfaces) or "unix:PATH", false if that fails
+        bool Open(const char* address);
+        void Close();
+        
+        bool IsOpen() const { return listener >= 0; }
+        
+        void Publish(GameState const& state, SpectatorScreen screen = SPECTATOR_PLAYING);
+        
+        SpectatorStats const& Stats() const { return stats; }
+        
+    private:
+        struct Message{
+            uint8_t bytes[MAX_SPECTATOR_MESSAGE];
+            uint8_t size;
+            
+            // Tick of the keyframe this message needs, its own tick for a keyframe
+            uint32_t keyframe;
+        };
+        
+        struct Client{
+            int fd;
+            
+            // Tick of the last keyframe this client received whole
+            uint32_t keyframe;
+            bool hasKeyframe;
+            
+            // The rest of a message the socket only took part of
+            uint8_t pending[MAX_SPECTATOR_MESSAGE];
+            std::size_t pendingBegin;
+            std::size_t pendingEnd;
+        };
+        
+        void Run();
+        void Accept();
+        bool Send(Client& client, Message const& message);
+        
+        int listener = -1;
+        std::string unixPath;
+        std::thread server;
+        std::atomic<bool> closing{false};
+        
+        // Producer side, only touched by Publish()
+        uint32_t tick = 0;
+        SpectatorState keyframe;
+        bool hasKeyframe = false;
+        
+        Message ring[RING_MESSAGES];
+        alignas(64) std::atomic<uint64_t> published{0};
+        alignas(64) std::atomic<uint64_t> consumed{0};
+        
+        // Server thread side
+        std::vector<Client> clients;
+        SpectatorStats stats;
+        uint64_t dropped = 0;
+};
+
+/*
+* A spectator: connects to a server and reads states off the stream
+*/
+class SpectatorClient{
+    public:
+        SpectatorClient() = default;
+        ~SpectatorClient();
+        
+        SpectatorClient(SpectatorClient const&) = delete;
+        SpectatorClient& operator=(SpectatorClient const&) = delete;
+        
+        // Connects to "HOST:PORT" or "unix:PATH"
+        bool Connect(const char* address);
+        void Close();
+        
+        // Waits for the next state, false once the server has gone
+        bool Next(SpectatorState& state);
+        
+        uint64_t BytesReceived() const { return bytesReceived; }
+        
+    private:
+        int fd = -1;
+        SpectatorDecoder decoder;
+        uint8_t buffer[4096];
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        uint64_t bytesReceived = 0;
+};
+
+} // namespace pong
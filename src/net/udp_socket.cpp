@@ -0,0 +1,90 @@
+#include "net/udp_socket.h"
+
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace pong {
+
+static sockaddr_in ToSockaddr(NetAddress const& address){
+    sockaddr_in result;
+    std::memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.ip);
+    result.sin_port = htons(address.port);
+    return result;
+}
+
+bool ResolveAddress(const char* host, uint16_t port, NetAddress& address){
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    
+    addrinfo* found = nullptr;
+    if(getaddrinfo(host, nullptr, &hints, &found) != 0 || !found){
+        return false;
+    }
+    address.ip = ntohl(reinterpret_cast<sockaddr_in*>(found->ai_addr)->sin_addr.s_addr);
+    address.port = port;
+    freeaddrinfo(found);
+    return true;
+}
+
+UdpSocket::~UdpSocket(){
+    Close();
+}
+
+bool UdpSocket::Open(uint16_t port){
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(fd < 0){
+        return false;
+    }
+    
+    sockaddr_in local = ToSockaddr(NetAddress{INADDR_ANY, port});
+    if(bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+       fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0){
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::Close(){
+    if(fd >= 0){
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool UdpSocket::SendTo(NetAddress const& to, const void* data, std::size_t size){
+    sockaddr_in remote = ToSockaddr(to);
+    return sendto(fd, data, size, 0, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == static_cast<ssize_t>(size);
+}
+
+std::size_t UdpSocket::Receive(void* buffer, std::size_t capacity, NetAddress& from){
+    sockaddr_in remote;
+    socklen_t length = sizeof(remote);
+    ssize_t received = recvfrom(fd, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&remote), &length);
+    if(received <= 0){
+        return 0;
+    }
+    from.ip = ntohl(remote.sin_addr.s_addr);
+    from.port = ntohs(remote.sin_port);
+    return static_cast<std::size_t>(received);
+}
+
+uint16_t UdpSocket::LocalPort() const{
+    sockaddr_in local;
+    socklen_t length = sizeof(local);
+    if(getsockname(fd, reinterpret_cast<sockaddr*>(&local), &length) != 0){
+        return 0;
+    }
+    return ntohs(local.sin_port);
+}
+
+} // namespace pong
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pong {
+
+// An IPv4 endpoint, both fields in host byte order
+struct NetAddress{
+    uint32_t ip = 0;
+    uint16_t port = 0;
+    
+    bool operator==(NetAddress const& rhs) const { return ip == rhs.ip && port == rhs.port; }
+    bool operator!=(NetAddress const& rhs) const { return !(*this == rhs); }
+};
+
+// Looks up `host` (a name or dotted address), false if it can't be resolved
+bool ResolveAddress(const char* host, uint16_t port, NetAddress& address);
+
+/*
+* Non-blocking UDP socket (POSIX sockets)
+*/
+class UdpSocket{
+    public:
+        UdpSocket() = default;
+        ~UdpSocket();
+        
+        UdpSocket(UdpSocket const&) = delete;
+        UdpSocket& operator=(UdpSocket const&) = delete;
+        
+        // Binds to `port` on all interfaces, 0 picks a free port
+        bool Open(uint16_t port);
+        void Close();
+        
+        bool SendTo(NetAddress const& to, const void* data, std::size_t size);
+        
+        // Size of the datagram received, 0 if none is waiting
+        std::size_t Receive(void* buffer, std::size_t capacity, NetAddress& from);
+        
+        uint16_t LocalPort() const;
+        
+    private:
+        int fd = -1;
+};
+
+} // namespace pong
@@ -0,0 +1,256 @@
+#include "options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static void PrintUsage(const char* program){
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --pacing=vsync|limit|uncapped   How frames are paced (default vsync)\n"
+        "  --fps=N                         Target frame rate for --pacing=limit (default 120)\n"
+        "  --trace=PATH                    Write a Chrome trace of every frame phase\n"
+        "  --profile-csv=PATH              Write per-frame phase timings as CSV\n"
+        "  --record=PATH                   Record the inputs of the match to a replay log\n"
+        "  --replay=PATH                   Play a replay log back in real time and verify it\n"
+        "  --host=PORT                     Wait for a network opponent on PORT, play the left paddle\n"
+        "  --connect=HOST:PORT             Join a match hosted on HOST, play the right paddle\n"
+        "  --net-delay=MS                  Simulated one-way network delay, for testing\n"
+        "  --net-jitter=MS                 Simulated random delay variation, for testing\n"
+        "  --net-loss=PCT                  Simulated packet loss, for testing\n"
+        "  --arena=N                       Arena mode: N balls on the field at once\n"
+        "  --audio-buffer=SAMPLES          Audio buffer size, lower is less latency (default 256)\n"
+        "  --audio-rate=HZ                 Preferred audio sample rate (default 48000)\n"
+        "  --sim-thread=on|off             Simulate on a separate thread (default on)\n"
+        "  --ai=left|right|both            Let the computer play these paddles\n"
+        "  --ai-reaction=MS                Computer reaction time (default 150)\n"
+        "  --ai-error=PX                   How far off the computer aims, at most (default 80)\n"
+        "  --physics=float|fixed           Simulate in floats or bit-exact fixed point (default float)\n"
+        "  --renderer=gpu|software         Draw with SDL's accelerated renderer or into the window surface (default gpu)\n"
+        "  --video=PATH                    Record the match to a Y4M video file\n"
+        "  --video-fps=N                   Frame rate of the video (default 60)\n"
+        "  --spectators=PORT|unix:PATH     Serve the match to read-only spectators\n"
+        "  --alloc-check=N                 Check N frames after warm-up for heap allocations, fail if any allocates\n",
+        program);
+}
+
+// Returns the text after `name=` if `arg` is that option, nullptr otherwise
+static const char* OptionValue(const char* arg, const char* name){
+    std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0 && arg[length] == '='){
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+// A UDP port, 0 if `value` isn't one
+static int ParsePort(const char* value){
+    int port = std::atoi(value);
+    return (port > 0 && port <= 65535) ? port : 0;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options){
+    for(int i = 1; i < argc; ++i){
+        const char* arg = argv[i];
+        
+        if(const char* value = OptionValue(arg, "--pacing")){
+            if(std::strcmp(value, "vsync") == 0){
+                options.pacing = PacingMode::Vsync;
+            }else if(std::strcmp(value, "limit") == 0){
+                options.pacing = PacingMode::Limit;
+            }else if(std::strcmp(value, "uncapped") == 0){
+                options.pacing = PacingMode::Uncapped;
+            }else{
+                std::fprintf(stderr, "Unknown pacing mode: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--fps")){
+            options.targetFps = std::atoi(value);
+            if(options.targetFps <= 0){
+                std::fprintf(stderr, "Invalid frame rate: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--trace")){
+            options.tracePath = value;
+        }else if(const char* value = OptionValue(arg, "--profile-csv")){
+            options.profileCsvPath = value;
+        }else if(const char* value = OptionValue(arg, "--record")){
+            options.recordPath = value;
+        }else if(const char* value = OptionValue(arg, "--replay")){
+            options.replayPath = value;
+        }else if(const char* value = OptionValue(arg, "--host")){
+            options.hostPort = ParsePort(value);
+            if(options.hostPort == 0){
+                std::fprintf(stderr, "Invalid port: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--connect")){
+            const char* colon = std::strrchr(value, ':');
+            options.connectPort = colon ? ParsePort(colon + 1) : 0;
+            if(options.connectPort == 0 || colon == value){
+                std::fprintf(stderr, "Expected HOST:PORT to connect to: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+            options.connectHost.assign(value, colon);
+        }else if(const char* value = OptionValue(arg, "--net-delay")){
+            options.netConditions.delayMs = std::atof(value);
+        }else if(const char* value = OptionValue(arg, "--net-jitter")){
+            options.netConditions.jitterMs = std::atof(value);
+        }else if(const char* value = OptionValue(arg, "--net-loss")){
+            options.netConditions.lossPercent = std::atof(value);
+        }else if(const char* value = OptionValue(arg, "--arena")){
+            options.arenaBalls = std::atoi(value);
+            if(options.arenaBalls <= 0){
+                std::fprintf(stderr, "Invalid ball count: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--audio-buffer")){
+            // SDL wants a power of two
+            options.audio.bufferSamples = std::atoi(value);
+            int samples = options.audio.bufferSamples;
+            if(samples < 32 || samples > 16384 || (samples & (samples - 1)) != 0){
+                std::fprintf(stderr, "Audio buffer must be a power of two from 32 to 16384: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--audio-rate")){
+            options.audio.frequency = std::atoi(value);
+            if(options.audio.frequency < 8000){
+                std::fprintf(stderr, "Invalid audio rate: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--sim-thread")){
+            if(std::strcmp(value, "on") == 0){
+                options.simulationThread = true;
+            }else if(std::strcmp(value, "off") == 0){
+                options.simulationThread = false;
+            }else{
+                std::fprintf(stderr, "Expected on or off: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--ai")){
+            options.aiLeft = std::strcmp(value, "left") == 0 || std::strcmp(value, "both") == 0;
+            options.aiRight = std::strcmp(value, "right") == 0 || std::strcmp(value, "both") == 0;
+            if(!options.aiLeft && !options.aiRight){
+                std::fprintf(stderr, "Expected left, right or both: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--ai-reaction")){
+            options.ai.reactionMs = static_cast<float>(std::atof(value));
+            if(options.ai.reactionMs < 0.0f){
+                std::fprintf(stderr, "Invalid reaction time: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--ai-error")){
+            options.ai.errorPx = static_cast<float>(std::atof(value));
+            if(options.ai.errorPx < 0.0f){
+                std::fprintf(stderr, "Invalid aim error: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--physics")){
+            if(std::strcmp(value, "float") == 0){
+                options.fixedPoint = false;
+            }else if(std::strcmp(value, "fixed") == 0){
+                options.fixedPoint = true;
+            }else{
+                std::fprintf(stderr, "Expected float or fixed: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--renderer")){
+            if(std::strcmp(value, "gpu") == 0){
+                options.softwareRenderer = false;
+            }else if(std::strcmp(value, "software") == 0){
+                options.softwareRenderer = true;
+            }else{
+                std::fprintf(stderr, "Expected gpu or software: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--spectators")){
+            options.spectatorAddress = value;
+        }else if(const char* value = OptionValue(arg, "--video")){
+            options.videoPath = value;
+        }else if(const char* value = OptionValue(arg, "--video-fps")){
+            options.videoFps = std::atoi(value);
+            if(options.videoFps <= 0 || options.videoFps > 1000){
+                std::fprintf(stderr, "Invalid video frame rate: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else if(const char* value = OptionValue(arg, "--alloc-check")){
+            options.allocationCheckFrames = std::atoi(value);
+            if(options.allocationCheckFrames <= 0){
+                std::fprintf(stderr, "Invalid frame count: %s\n", value);
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }else{
+            std::fprintf(stderr, "Unknown option: %s\n", arg);
+            PrintUsage(argv[0]);
+            return false;
+        }
+    }
+    
+    if(options.hostPort != 0 && !options.connectHost.empty()){
+        std::fprintf(stderr, "Use either --host or --connect, not both\n");
+        return false;
+    }
+    
+    // A netplay match is driven by two keyboards, there is no single input log to record or play
+    bool networked = options.hostPort != 0 || !options.connectHost.empty();
+    if(networked && (options.recordPath || options.replayPath)){
+        std::fprintf(stderr, "--record and --replay can't be used in a network match\n");
+        return false;
+    }
+    
+    // Logs and netplay only know about the single ball of a match
+    if(options.arenaBalls > 0 && (networked || options.recordPath || options.replayPath)){
+        std::fprintf(stderr, "--arena can't be combined with netplay, --record or --replay\n");
+        return false;
+    }
+    
+    // The computer plays a single ball on the local machine, a replay already knows every input
+    if((options.aiLeft || options.aiRight) && (options.arenaBalls > 0 || networked || options.replayPath)){
+        std::fprintf(stderr, "--ai can't be combined with --arena, netplay or --replay\n");
+        return false;
+    }
+    
+    // Netplay and the arena only simulate in floats, a replay brings its own physics
+    if(options.fixedPoint && (options.arenaBalls > 0 || networked || options.replayPath)){
+        std::fprintf(stderr, "--physics=fixed can't be combined with --arena, netplay or --replay\n");
+        return false;
+    }
+    
+    /*
+    * A video runs on its own clock, one video frame per loop, which a network peer can't follow;
+    * the frames are drawn offscreen, which the window surface renderer can't do
+    */
+    if(options.videoPath && (networked || options.softwareRenderer)){
+        std::fprintf(stderr, "--video can't be combined with netplay or --renderer=software\n");
+        return false;
+    }
+    
+    // The spectator stream carries the one ball of a match
+    if(options.spectatorAddress && options.arenaBalls > 0){
+        std::fprintf(stderr, "--spectators can't be combined with --arena\n");
+        return false;
+    }
+    
+    // The check walks through the screens by itself, a network match waits for the peer instead
+    if(options.allocationCheckFrames > 0 && networked){
+        std::fprintf(stderr, "--alloc-check can't be combined with netplay\n");
+        return false;
+    }
+    return true;
+}
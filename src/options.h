@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+
+#include "core/ai.h"
+#include "frame_pacer.h"
+#include "net/link_conditioner.h"
+#include "sound_board.h"
+
+/*
+* Command line options of the SDL frontend
+*   --pacing=vsync|limit|uncapped   How frames are paced (default vsync)
+*   --fps=N                         Target frame rate for --pacing=limit (default 120)
+*   --trace=PATH                    Write a Chrome trace of every frame phase
+*   --profile-csv=PATH              Write per-frame phase timings as CSV
+*   --record=PATH                   Record the inputs of the match to a replay log
+*   --replay=PATH                   Play a replay log back in real time and verify it
+*   --host=PORT                     Wait for a network opponent on PORT, play the left paddle
+*   --connect=HOST:PORT             Join a match hosted on HOST, play the right paddle
+*   --net-delay=MS                  Simulated one-way network delay, for testing
+*   --net-jitter=MS                 Simulated random delay variation, for testing
+*   --net-loss=PCT                  Simulated packet loss, for testing
+*   --arena=N                       Arena mode: N balls on the field at once
+*   --audio-buffer=SAMPLES          Audio buffer size, lower is less latency (default 256)
+*   --audio-rate=HZ                 Preferred audio sample rate (default 48000)
+*   --sim-thread=on|off             Simulate on a separate thread (default on)
+*   --ai=left|right|both            Let the computer play these paddles
+*   --ai-reaction=MS                Computer reaction time (default 150)
+*   --ai-error=PX                   How far off the computer aims, at most (default 80)
+*   --physics=float|fixed           Simulate in floats or bit-exact fixed point (default float)
+*   --renderer=gpu|software         Draw with SDL's accelerated renderer or into the window surface (default gpu)
+*   --video=PATH                    Record the match to a Y4M video file
+*   --video-fps=N                   Frame rate of the video (default 60)
+*   --spectators=PORT|unix:PATH     Serve the match to read-only spectators
+*   --alloc-check=N                 Check N frames after warm-up for heap allocations, fail if any allocates
+*/
+struct Options{
+    PacingMode pacing = PacingMode::Vsync;
+    int targetFps = 120;
+    const char* tracePath = nullptr;
+    const char* profileCsvPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    
+    // Netplay, enabled by either --host or --connect
+    int hostPort = 0;
+    std::string connectHost;
+    int connectPort = 0;
+    pong::LinkConditions netConditions;
+    
+    // Number of balls in arena mode, 0 for a normal match
+    int arenaBalls = 0;
+    
+    AudioSettings audio;
+    
+    // Step the simulation on its own thread instead of between frames
+    bool simulationThread = true;
+    
+    // Computer players, the settings apply to both
+    bool aiLeft = false;
+    bool aiRight = false;
+    pong::AiSettings ai;
+    
+    // Simulate the match in pong::Fixed, so recordings reproduce on any machine
+    bool fixedPoint = false;
+    
+    // Draw on the CPU into the window surface and only update the parts that changed
+    bool softwareRenderer = false;
+    
+    // Y4M video of the match, every frame advances the game by 1/videoFps seconds
+    const char* videoPath = nullptr;
+    int videoFps = 60;
+    
+    // Where spectators connect, a TCP port or unix:PATH
+    const char* spectatorAddress = nullptr;
+    
+    // Frames to check for heap allocations before exiting, 0 to play normally
+    int allocationCheckFrames = 0;
+};
+
+// Fills `options` from the command line, prints the usage and returns false on a bad argument
+bool ParseOptions(int argc, char* argv[], Options& options);
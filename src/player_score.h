@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+#include "core/vec2.h"
+#include "text_atlas.h"
+
+class PlayerScore{
+    public:
+        GlyphAtlas& atlas;
+        SDL_Rect rect;
+        
+        // Large enough for any int, so setScore never allocates
+        char text[12];
+        
+        PlayerScore(pong::Vec2 position, GlyphAtlas& atlas) : atlas(atlas){
+    		rect.x = static_cast<int>(position.x);
+    		rect.y = static_cast<int>(position.y);
+    		setScore(0);
+        }
+        
+        // Queues the score on the atlas, the caller flushes the atlas once for all scores
+        void Draw(){
+            atlas.QueueText(text, rect.x, rect.y, {0xFF, 0xFF, 0xFF, 0xFF});
+        }
+        
+        /*
+        * setScore function is called when the score changes 
+        * - The text is formatted into the fixed buffer, the glyphs themselves
+        *   come from the atlas so no surface or texture is created
+        */
+        void setScore(int score){
+            SDL_snprintf(text, sizeof(text), "%d", score);
+            rect.w = atlas.TextWidth(text);
+            rect.h = atlas.LineHeight();
+        }
+};
@@ -0,0 +1,207 @@
+#include "profiler.h"
+
+#include <algorithm>
+
+#include "allocation_tracker.h"
+#include "text_atlas.h"
+
+// How often the overlay text is refreshed, in seconds
+static const double OVERLAY_REFRESH_SECONDS = 0.5;
+
+const char* PhaseName(Phase phase){
+    switch(phase){
+        case Phase::Events:
+            return "events";
+        case Phase::Paddles:
+            return "paddles";
+        case Phase::Ball:
+            return "ball";
+        case Phase::Collisions:
+            return "collisions";
+        case Phase::Clear:
+            return "clear";
+        case Phase::Playfield:
+            return "playfield";
+        case Phase::Scores:
+            return "scores";
+        case Phase::Capture:
+            return "capture";
+        case Phase::Overlay:
+            return "overlay";
+        case Phase::Present:
+            return "present";
+        case Phase::Count:
+            break;
+    }
+    return "unknown";
+}
+
+Profiler::Profiler(){
+    frequency = SDL_GetPerformanceFrequency();
+    traceOrigin = SDL_GetPerformanceCounter();
+}
+
+Profiler::~Profiler(){
+    if(trace){
+        std::fputs("\n]}\n", trace);
+        std::fclose(trace);
+    }
+    if(csv){
+        std::fclose(csv);
+    }
+}
+
+bool Profiler::OpenTrace(const char* path){
+    trace = std::fopen(path, "w");
+    if(!trace){
+        return false;
+    }
+    std::fputs("{\"traceEvents\":[\n", trace);
+    return true;
+}
+
+bool Profiler::OpenCsv(const char* path){
+    csv = std::fopen(path, "w");
+    if(!csv){
+        return false;
+    }
+    
+    // Header: frame time followed by one column per phase, all in milliseconds,
+    // then the frame's heap allocations in total and per phase
+    std::fputs("frame_ms", csv);
+    for(int i = 0; i < PHASE_COUNT; ++i){
+        std::fprintf(csv, ",%s_ms", PhaseName(static_cast<Phase>(i)));
+    }
+    std::fputs(",frame_allocs", csv);
+    for(int i = 0; i < PHASE_COUNT; ++i){
+        std::fprintf(csv, ",%s_allocs", PhaseName(static_cast<Phase>(i)));
+    }
+    std::fputc('\n', csv);
+    return true;
+}
+
+float Profiler::TicksToMs(Uint64 ticks) const{
+    return static_cast<float>(static_cast<double>(ticks) * 1000.0 / frequency);
+}
+
+void Profiler::WriteTraceEvent(const char* name, Uint64 start, Uint64 duration){
+    double startUs = static_cast<double>(start - traceOrigin) * 1000000.0 / frequency;
+    double durationUs = static_cast<double>(duration) * 1000000.0 / frequency;
+    std::fprintf(trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                 firstTraceEvent ? "" : ",\n", name, startUs, durationUs);
+    firstTraceEvent = false;
+}
+
+void Profiler::BeginFrame(){
+    frameStart = SDL_GetPerformanceCounter();
+    std::fill(std::begin(phaseTicks), std::end(phaseTicks), 0);
+    std::fill(std::begin(phaseAllocations), std::end(phaseAllocations), 0);
+    frameAllocationStart = ThreadAllocations();
+}
+
+void Profiler::EndFrame(){
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 frameTicks = now - frameStart;
+    lastFrameAllocations = ThreadAllocations() - frameAllocationStart;
+    std::copy(std::begin(phaseAllocations), std::end(phaseAllocations), lastPhaseAllocations);
+    
+    frameHistory[historyNext] = TicksToMs(frameTicks);
+    for(int i = 0; i < PHASE_COUNT; ++i){
+        phaseHistory[i][historyNext] = TicksToMs(phaseTicks[i]);
+    }
+    allocationHistory[historyNext] = static_cast<float>(lastFrameAllocations);
+    historyNext = (historyNext + 1) % HISTORY;
+    historyCount = std::min(historyCount + 1, HISTORY);
+    
+    if(trace){
+        WriteTraceEvent("frame", frameStart, frameTicks);
+    }
+    if(csv){
+        std::fprintf(csv, "%.4f", TicksToMs(frameTicks));
+        for(int i = 0; i < PHASE_COUNT; ++i){
+            std::fprintf(csv, ",%.4f", TicksToMs(phaseTicks[i]));
+        }
+        std::fprintf(csv, ",%llu", static_cast<unsigned long long>(lastFrameAllocations));
+        for(int i = 0; i < PHASE_COUNT; ++i){
+            std::fprintf(csv, ",%llu", static_cast<unsigned long long>(lastPhaseAllocations[i]));
+        }
+        std::fputc('\n', csv);
+    }
+}
+
+void Profiler::Begin(Phase phase){
+    int index = static_cast<int>(phase);
+    phaseStart[index] = SDL_GetPerformanceCounter();
+    phaseAllocationStart[index] = ThreadAllocations();
+}
+
+void Profiler::End(Phase phase){
+    int index = static_cast<int>(phase);
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 duration = now - phaseStart[index];
+    phaseTicks[index] += duration;
+    phaseAllocations[index] += ThreadAllocations() - phaseAllocationStart[index];
+    
+    if(trace){
+        WriteTraceEvent(PhaseName(phase), phaseStart[index], duration);
+    }
+}
+
+float Profiler::Percentile(const float* history, int count, float p) const{
+    if(count == 0){
+        return 0.0f;
+    }
+    
+    std::copy(history, history + count, scratch);
+    int rank = static_cast<int>(p / 100.0f * (count - 1) + 0.5f);
+    std::nth_element(scratch, scratch + rank, scratch + count);
+    return scratch[rank];
+}
+
+float Profiler::FramePercentile(float p) const{
+    return Percentile(frameHistory, historyCount, p);
+}
+
+float Profiler::PhasePercentile(Phase phase, float p) const{
+    return Percentile(phaseHistory[static_cast<int>(phase)], historyCount, p);
+}
+
+void Profiler::AddInputLatency(float ms){
+    latencyHistory[latencyNext] = ms;
+    latencyNext = (latencyNext + 1) % HISTORY;
+    latencyCount = std::min(latencyCount + 1, HISTORY);
+}
+
+float Profiler::InputLatencyPercentile(float p) const{
+    return Percentile(latencyHistory, latencyCount, p);
+}
+
+void Profiler::UpdateOverlayText(){
+    SDL_snprintf(overlayLines[0], sizeof(overlayLines[0]), "%-10s %7s %7s %7s", "ms", "p50", "p95", "p99");
+    SDL_snprintf(overlayLines[1], sizeof(overlayLines[1]), "%-10s %7.3f %7.3f %7.3f", "frame",
+                 FramePercentile(50.0f), FramePercentile(95.0f), FramePercentile(99.0f));
+    for(int i = 0; i < PHASE_COUNT; ++i){
+        Phase phase = static_cast<Phase>(i);
+        SDL_snprintf(overlayLines[i + 2], sizeof(overlayLines[i + 2]), "%-10s %7.3f %7.3f %7.3f", PhaseName(phase),
+                     PhasePercentile(phase, 50.0f), PhasePercentile(phase, 95.0f), PhasePercentile(phase, 99.0f));
+    }
+    SDL_snprintf(overlayLines[PHASE_COUNT + 2], sizeof(overlayLines[PHASE_COUNT + 2]), "%-10s %7.3f %7.3f %7.3f", "input",
+                 InputLatencyPercentile(50.0f), InputLatencyPercentile(95.0f), InputLatencyPercentile(99.0f));
+    SDL_snprintf(overlayLines[PHASE_COUNT + 3], sizeof(overlayLines[PHASE_COUNT + 3]), "%-10s %7.0f %7.0f %7.0f", "allocs",
+                 Percentile(allocationHistory, historyCount, 50.0f), Percentile(allocationHistory, historyCount, 95.0f),
+                 Percentile(allocationHistory, historyCount, 99.0f));
+}
+
+void Profiler::DrawOverlay(GlyphAtlas& atlas, int x, int y){
+    Uint64 now = SDL_GetPerformanceCounter();
+    if(lastOverlayUpdate == 0 || now - lastOverlayUpdate > static_cast<Uint64>(OVERLAY_REFRESH_SECONDS * frequency)){
+        UpdateOverlayText();
+        lastOverlayUpdate = now;
+    }
+    
+    SDL_Color color = {0x40, 0xFF, 0x40, 0xFF};
+    for(int i = 0; i < OVERLAY_LINES; ++i){
+        atlas.QueueText(overlayLines[i], x, y + i * atlas.LineHeight(), color);
+    }
+    atlas.Flush();
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <SDL2/SDL.h>
+
+class GlyphAtlas;
+
+// The parts of a frame the profiler measures, in the order they run
+enum class Phase{
+    Events,
+    Paddles,
+    Ball,
+    Collisions,
+    Clear,
+    Playfield,
+    Scores,
+    Capture,
+    Overlay,
+    Present,
+    Count
+};
+
+const char* PhaseName(Phase phase);
+
+/*
+* Per-phase frame profiler
+*   - Time spent in each phase is summed over a frame (a frame may run several
+*     simulation steps) and kept for the last HISTORY frames
+*   - The overlay shows frame time and per-phase percentiles over that history
+*   - Heap allocations the render thread makes are counted per phase the same way,
+*     see allocation_tracker.h
+*   - Optionally every phase is also streamed to a Chrome trace (chrome://tracing,
+*     Perfetto) and one row per frame to a CSV file
+*   - All storage is fixed size, so profiling itself doesn't allocate per frame
+*/
+class Profiler{
+    public:
+        static const int HISTORY = 512;
+        
+        Profiler();
+        ~Profiler();
+        
+        Profiler(Profiler const&) = delete;
+        Profiler& operator=(Profiler const&) = delete;
+        
+        // Start streaming to these files, false if the file can't be created
+        bool OpenTrace(const char* path);
+        bool OpenCsv(const char* path);
+        
+        void BeginFrame();
+        void EndFrame();
+        void Begin(Phase phase);
+        void End(Phase phase);
+        
+        // p-th percentile (0 to 100) over the recorded frames, in milliseconds
+        float FramePercentile(float p) const;
+        float PhasePercentile(Phase phase, float p) const;
+        
+        // Heap allocations during the last finished frame, in total and per phase
+        uint64_t FrameAllocations() const { return lastFrameAllocations; }
+        uint64_t PhaseAllocations(Phase phase) const { return lastPhaseAllocations[static_cast<int>(phase)]; }
+        
+        // Time from a key change to the end of presenting the first frame showing it
+        void AddInputLatency(float ms);
+        float InputLatencyPercentile(float p) const;
+        int InputLatencyCount() const { return latencyCount; }
+        
+        void ToggleOverlay() { overlayVisible = !overlayVisible; }
+        bool OverlayVisible() const { return overlayVisible; }
+        
+        // Draws the statistics with their upper left corner at (x, y)
+        void DrawOverlay(GlyphAtlas& atlas, int x, int y);
+        
+    private:
+        static const int PHASE_COUNT = static_cast<int>(Phase::Count);
+        static const int OVERLAY_LINES = PHASE_COUNT + 4;
+        
+        float Percentile(const float* history, int count, float p) const;
+        float TicksToMs(Uint64 ticks) const;
+        void WriteTraceEvent(const char* name, Uint64 start, Uint64 duration);
+        void UpdateOverlayText();
+        
+        Uint64 frequency;
+        Uint64 frameStart = 0;
+        Uint64 phaseStart[PHASE_COUNT] = {};
+        Uint64 phaseTicks[PHASE_COUNT] = {};
+        
+        // Allocation counts of the frame in progress and of the last finished one
+        uint64_t frameAllocationStart = 0;
+        uint64_t phaseAllocationStart[PHASE_COUNT] = {};
+        uint64_t phaseAllocations[PHASE_COUNT] = {};
+        uint64_t lastFrameAllocations = 0;
+        uint64_t lastPhaseAllocations[PHASE_COUNT] = {};
+        
+        // Ring buffers of the last HISTORY frames, in milliseconds
+        float frameHistory[HISTORY] = {};
+        float phaseHistory[PHASE_COUNT][HISTORY] = {};
+        float allocationHistory[HISTORY] = {};
+        int historyCount = 0;
+        int historyNext = 0;
+        mutable float scratch[HISTORY];
+        
+        // The last HISTORY input latencies, in milliseconds
+        float latencyHistory[HISTORY] = {};
+        int latencyCount = 0;
+        int latencyNext = 0;
+        
+        std::FILE* trace = nullptr;
+        std::FILE* csv = nullptr;
+        Uint64 traceOrigin = 0;
+        bool firstTraceEvent = true;
+        
+        // The overlay text is only reformatted a few times per second so it stays readable
+        bool overlayVisible = false;
+        Uint64 lastOverlayUpdate = 0;
+        char overlayLines[OVERLAY_LINES][96] = {};
+};
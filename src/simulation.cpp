@@ -0,0 +1,271 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <SDL2/SDL.h>
+
+#include "profiler.h"
+
+static pong::NetplayConfig NetplayConfigFrom(Options const& options){
+    pong::NetplayConfig config;
+    config.host = options.hostPort != 0;
+    config.localPort = static_cast<uint16_t>(options.hostPort);
+    config.remoteHost = options.connectHost.c_str();
+    config.remotePort = static_cast<uint16_t>(options.connectPort);
+    config.conditions = options.netConditions;
+    return config;
+}
+
+Simulation::Simulation(Options const& options)
+    : recordPath(options.recordPath), netplay(NetplayConfigFrom(options)), netStart(std::chrono::steady_clock::now()){
+    /*
+    * Computer players
+    *   - They press the buttons of their paddle like a player would, so a recording
+    *     made against the computer replays without it
+    *   - Seeded from the clock so every match plays out differently, the seed (never 0) goes
+    *     into a recording
+    */
+    uint32_t aiSeed = static_cast<uint32_t>(netStart.time_since_epoch().count()) | 1u;
+    pong::AiSettings settings = options.ai;
+    settings.seed = aiSeed;
+    computerPlays[0] = options.aiLeft;
+    computerPlays[1] = options.aiRight;
+    computer[0] = pong::PaddleAi(0, settings);
+    settings.seed ^= 0x9E3779B9u;
+    computer[1] = pong::PaddleAi(1, settings);
+    
+    /*
+    * Input logs
+    *   - --record writes the inputs of every simulation step
+    *   - --replay drives the match from a log instead of the keyboard, in real time,
+    *     and checks the final score and state hash once the log ends
+    */
+    fixedPoint = options.fixedPoint;
+    pong::ReplayHeader header;
+    header.fixedPoint = fixedPoint;
+    if(computerPlays[0] || computerPlays[1]){
+        header.seed = aiSeed;
+    }
+    if(options.recordPath && !recorder.Open(options.recordPath, header)){
+        SDL_Log("Failed to create replay file: %s", options.recordPath);
+    }
+    
+    replaying = options.replayPath != nullptr;
+    if(replaying){
+        if(!replay.Open(options.replayPath)){
+            SDL_Log("Failed to open replay %s: %s", options.replayPath, replay.Error());
+            ok = false;
+        }else if(!pong::SameRules(replay.Header())){
+            SDL_Log("Replay %s was recorded with different rule constants", options.replayPath);
+            ok = false;
+        }
+        collisionMode = replay.Header().mode;
+        fixedPoint = replay.Header().fixedPoint;
+    }
+    
+    /*
+    * Netplay
+    *   - The host plays the left paddle and the client the right one, either with
+    *     w/s or k/j, and the match starts as soon as the two have found each other
+    *   - Steps run through the rollback session, so the local paddle reacts at once
+    *     and the match is corrected when the other player's inputs arrive
+    */
+    networked = options.hostPort != 0 || !options.connectHost.empty();
+    if(networked && !netplay.Start()){
+        SDL_Log("Failed to start the network match");
+        ok = false;
+    }
+    
+    // Key changes pile up here between steps, a few dozen is already a lot
+    pendingInputs.reserve(64);
+    stepEvents.reserve(64);
+    
+    // Spectators are served from their own thread, a step only encodes its state once for all of them
+    if(options.spectatorAddress){
+        if(spectators.Open(options.spectatorAddress)){
+            SDL_Log("Serving spectators on %s", options.spectatorAddress);
+        }else{
+            SDL_Log("Failed to serve spectators on %s", options.spectatorAddress);
+            ok = false;
+        }
+    }
+    
+    // Arena mode: hundreds or thousands of balls on one field, stepped by pong::StepArena
+    arenaMode = options.arenaBalls > 0;
+    if(arenaMode){
+        arena = pong::NewArena(options.arenaBalls);
+    }
+}
+
+double Simulation::NetNow() const{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - netStart).count();
+}
+
+void Simulation::Poll(){
+    if(networked){
+        netplay.Poll(NetNow());
+        
+        // The events wait in the session for the next step, so they are reported once
+        match = netplay.State();
+        match.events = pong::EVENT_NONE;
+    }
+}
+
+void Simulation::AddInput(ButtonChange const& change){
+    pendingInputs.push_back(change);
+}
+
+bool Simulation::Step(std::chrono::steady_clock::time_point due, Profiler* profiler){
+    if(!Advance(due, profiler)){
+        return false;
+    }
+    if(spectators.IsOpen()){
+        spectators.Publish(match);
+    }
+    return true;
+}
+
+void Simulation::ShowStartScreen(){
+    if(spectators.IsOpen()){
+        spectators.Publish(match, pong::SPECTATOR_START_SCREEN);
+    }
+}
+
+bool Simulation::Advance(std::chrono::steady_clock::time_point due, Profiler* profiler){
+    // Phase timing is optional, a null profiler records nothing
+    auto begin = [profiler](Phase phase){ if(profiler) profiler->Begin(phase); };
+    auto end = [profiler](Phase phase){ if(profiler) profiler->End(phase); };
+    
+    // Turn the changes up to the end of this step into times within it
+    auto stepStart = due - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float, std::milli>(pong::FIXED_DT));
+    pong::Inputs stepStartButtons = held;
+    stepEvents.clear();
+    std::size_t consumed = 0;
+    for(; consumed < pendingInputs.size() && pendingInputs[consumed].time <= due; ++consumed){
+        ButtonChange const& change = pendingInputs[consumed];
+        float time = std::chrono::duration<float, std::milli>(change.time - stepStart).count();
+        
+        // Keep the events in order even if the clock conversion jittered
+        float earliest = stepEvents.empty() ? 0.0f : stepEvents.back().time;
+        stepEvents.push_back(pong::InputEvent{std::min(std::max(time, earliest), pong::FIXED_DT), change.button, change.pressed});
+        held.buttons[change.button] = change.pressed;
+        lastInputTime = std::max(lastInputTime, change.time);
+    }
+    pendingInputs.erase(pendingInputs.begin(), pendingInputs.begin() + consumed);
+    
+    if(networked){
+        // Either key pair drives this player's paddle
+        pong::PlayerInput local = pong::PlayerInputFrom(held, 0) | pong::PlayerInputFrom(held, 1);
+        
+        // A step that has to wait is skipped, which is what lets a peer that got ahead fall back
+        begin(Phase::Ball);
+        bool stepped = netplay.Step(local, NetNow());
+        end(Phase::Ball);
+        if(stepped){
+            match = netplay.State();
+        }
+        
+        // Also a step that waited, a rollback in Poll() may have turned up hits of its own
+        match.events = netplay.TakeEvents();
+        return true;
+    }
+    
+    if(arenaMode){
+        begin(Phase::Ball);
+        pong::StepArena(arena, stepStartButtons, pong::FIXED_DT, arenaGrid, stepEvents.data(), static_cast<int>(stepEvents.size()));
+        end(Phase::Ball);
+        
+        match.paddleLeft = arena.paddleLeft;
+        match.paddleRight = arena.paddleRight;
+        match.leftScore = arena.leftScore;
+        match.rightScore = arena.rightScore;
+        match.events = arena.events;
+        return true;
+    }
+    
+    // The keyboard doesn't move a paddle the computer plays, Buttons go up and down per player
+    if(computerPlays[0] || computerPlays[1]){
+        auto computerButton = [this](pong::InputEvent const& event){ return computerPlays[event.button / 2]; };
+        stepEvents.erase(std::remove_if(stepEvents.begin(), stepEvents.end(), computerButton), stepEvents.end());
+        for(pong::PaddleAi& ai : computer){
+            if(!computerPlays[ai.Player()])
+                continue;
+            
+            ai.Drive(match, pong::FIXED_DT, held);
+            for(int button = ai.Player() * 2; button < ai.Player() * 2 + 2; ++button){
+                stepStartButtons.buttons[button] = held.buttons[button];
+            }
+        }
+    }
+    
+    pong::Inputs inputs = held;
+    if(replaying && !replay.Next(inputs)){
+        // The log is over, check that it played out as recorded
+        pong::ReplayFooter const& expected = replay.Footer();
+        if(replay.Error()){
+            SDL_Log("Replay failed: %s", replay.Error());
+        }else if(match.leftScore == expected.leftScore && match.rightScore == expected.rightScore &&
+                 (fixedPoint ? pong::HashState(fixedMatch) : pong::HashState(match)) == expected.hash){
+            SDL_Log("Replay reproduced: %d-%d", match.leftScore, match.rightScore);
+        }else{
+            SDL_Log("Replay diverged: got %d-%d, recorded %d-%d", match.leftScore, match.rightScore,
+                    expected.leftScore, expected.rightScore);
+        }
+        replaying = false;
+        return false;
+    }
+    recorder.Record(inputs);
+    
+    // Fixed point steps with whole-step inputs, like a recording, and is drawn from a float copy
+    if(fixedPoint){
+        begin(Phase::Ball);
+        fixedMatch = pong::Step(fixedMatch, inputs, pong::Constants<pong::Fixed>::fixedDt, collisionMode);
+        match = pong::ToFloat(fixedMatch);
+        end(Phase::Ball);
+        return true;
+    }
+    
+    // The phases of pong::Step, run one by one so each can be timed
+    match.events = pong::EVENT_NONE;
+    begin(Phase::Paddles);
+    if(replaying || recorder.IsOpen()){
+        pong::UpdatePaddles(match, inputs, pong::FIXED_DT);
+    }else{
+        pong::UpdatePaddlesTimed(match, stepStartButtons, stepEvents.data(), static_cast<int>(stepEvents.size()), pong::FIXED_DT);
+    }
+    end(Phase::Paddles);
+    begin(Phase::Ball);
+    pong::UpdateBall(match, pong::FIXED_DT, collisionMode);
+    end(Phase::Ball);
+    begin(Phase::Collisions);
+    pong::ResolveCollisions(match, collisionMode);
+    end(Phase::Collisions);
+    return true;
+}
+
+void Simulation::Capture(Snapshot& snapshot) const{
+    snapshot.match = match;
+    if(arenaMode){
+        // Assigning into the old vector reuses its storage once it has grown to the ball count
+        snapshot.arenaBalls.assign(arena.balls.begin(), arena.balls.end());
+    }
+    snapshot.waitingForPeer = networked && !netplay.Connected();
+    snapshot.lastInputTime = lastInputTime;
+}
+
+void Simulation::Finish(){
+    if(spectators.IsOpen()){
+        spectators.Close();
+        pong::SpectatorStats const& served = spectators.Stats();
+        SDL_Log("Spectators: %llu served, %llu messages sent, %llu skipped for slow spectators",
+                static_cast<unsigned long long>(served.clientsServed), static_cast<unsigned long long>(served.messagesSent),
+                static_cast<unsigned long long>(served.skipped));
+    }
+    if(!recorder.IsOpen()){
+        return;
+    }
+    bool finished = fixedPoint ? recorder.Finish(fixedMatch) : recorder.Finish(match);
+    if(!finished){
+        SDL_Log("Failed to write replay file: %s", recordPath);
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "core/ai.h"
+#include "core/arena.h"
+#include "core/game.h"
+#include "core/replay.h"
+#include "input_queue.h"
+#include "net/netplay.h"
+#include "net/spectator.h"
+#include "options.h"
+
+class Profiler;
+
+// What drawing a frame needs from the simulation
+struct Snapshot{
+    pong::GameState match;
+    std::vector<pong::Ball> arenaBalls;
+    bool waitingForPeer = false;
+    
+    // When the last step was due, a frame drawn FIXED_DT later shows it fully
+    std::chrono::steady_clock::time_point stepTime;
+    
+    // When the newest button change this state reflects happened, for measuring latency
+    std::chrono::steady_clock::time_point lastInputTime;
+};
+
+/*
+* Everything that advances the game: the match or arena, replays, recording, netplay and computer players
+*   - Owns no SDL objects, so it can run on the main thread or on its own (see SimulationThread)
+*   - In arena mode the paddles, scores and events are copied into Match() after each
+*     step, so the frontend reads them the same way in every mode
+*   - With --spectators every step is published to the spectator server, and the start
+*     screen once per frame before that
+*/
+class Simulation{
+    public:
+        explicit Simulation(Options const& options);
+        
+        // False if a replay or the network match couldn't be set up
+        bool Ok() const { return ok; }
+        
+        // Replays and network matches skip the start screen
+        bool StartsPlaying() const { return replaying || networked; }
+        
+        // Exchanges network packets, call once per loop before stepping
+        void Poll();
+        
+        // A key change from the keyboard, in the order they happened
+        void AddInput(ButtonChange const& change);
+        
+        /*
+        * Runs the fixed step that ends at `due`, false once the match is over (a replay ended)
+        *   - Button changes up to `due` are applied at the time they happened within the
+        *     step; changes from before the step (they arrived late) at its start
+        *   - Replays, recordings, netplay and fixed point use whole-step inputs, there
+        *     every change takes effect at the start of the step
+        *   - Times its phases with `profiler` when given one
+        */
+        bool Step(std::chrono::steady_clock::time_point due, Profiler* profiler = nullptr);
+        
+        // Tells spectators the frontend is on its start screen, call once per frame there, before the first Step()
+        void ShowStartScreen();
+        
+        // Copies what the renderer needs into `snapshot`, reusing its storage
+        void Capture(Snapshot& snapshot) const;
+        
+        pong::GameState const& Match() const { return match; }
+        
+        // Writes the end of the recording, if one is being made, and stops serving spectators
+        void Finish();
+        
+    private:
+        double NetNow() const;
+        bool Advance(std::chrono::steady_clock::time_point due, Profiler* profiler);
+        
+        const char* recordPath;
+        bool ok = true;
+        pong::GameState match = pong::NewGame();
+        
+        // The match itself when simulating in fixed point, `match` is then a float copy of it
+        bool fixedPoint = false;
+        pong::FixedGameState fixedMatch = pong::NewGame<pong::Fixed>();
+        
+        // The buttons held at the end of the last step, and the changes not yet stepped
+        pong::Inputs held;
+        std::vector<ButtonChange> pendingInputs;
+        std::vector<pong::InputEvent> stepEvents;
+        std::chrono::steady_clock::time_point lastInputTime;
+        pong::CollisionMode collisionMode = pong::CollisionMode::Discrete;
+        
+        pong::ReplayWriter recorder;
+        pong::ReplayReader replay;
+        bool replaying = false;
+        
+        bool networked = false;
+        pong::Netplay netplay;
+        std::chrono::steady_clock::time_point netStart;
+        
+        // Computer players, indexed by player like pong::PaddleAi::Player()
+        pong::PaddleAi computer[2];
+        bool computerPlays[2] = {false, false};
+        
+        bool arenaMode = false;
+        pong::ArenaState arena;
+        pong::BallGrid arenaGrid;
+        
+        pong::SpectatorServer spectators;
+};
@@ -0,0 +1,97 @@
+#include "simulation_thread.h"
+
+#include "allocation_tracker.h"
+
+SimulationThread::SimulationThread(Simulation& simulation) : simulation(simulation){
+}
+
+SimulationThread::~SimulationThread(){
+    Stop();
+}
+
+void SimulationThread::Start(){
+    if(thread.joinable()){
+        return;
+    }
+    stopping.store(false);
+    
+    // The first snapshot is there before Start() returns, so the frame that started the thread never sees an empty one
+    simulation.Capture(snapshots.Back());
+    snapshots.Back().stepTime = std::chrono::steady_clock::now();
+    snapshots.Publish();
+    
+    thread = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop(){
+    stopping.store(true);
+    if(thread.joinable()){
+        thread.join();
+    }
+}
+
+unsigned SimulationThread::TakeEvents(){
+    return events.exchange(pong::EVENT_NONE, std::memory_order_relaxed);
+}
+
+Snapshot const& SimulationThread::Latest(){
+    snapshots.Update();
+    return snapshots.Front();
+}
+
+void SimulationThread::Run(){
+    using Clock = std::chrono::steady_clock;
+    const auto step = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float, std::milli>(pong::FIXED_DT));
+    
+    // Steps are due at fixed times from the start, the thread sleeps in between
+    auto nextStep = Clock::now();
+    
+    while(!stopping.load(std::memory_order_relaxed)){
+        simulation.Poll();
+        
+        ButtonChange change;
+        while(inputs.Pop(change)){
+            simulation.AddInput(change);
+        }
+        
+        /*
+        * Run every step that is due
+        *   - After a long stall (the thread wasn't scheduled, a debugger stopped it) at most
+        *     MAX_CATCH_UP_STEPS are run and the rest of the time is dropped, the game slows
+        *     down instead of spiralling
+        */
+        const int MAX_CATCH_UP_STEPS = 12;
+        int steps = 0;
+        auto now = Clock::now();
+        unsigned stepEvents = pong::EVENT_NONE;
+        bool over = false;
+        while(nextStep <= now && steps < MAX_CATCH_UP_STEPS){
+            if(!simulation.Step(nextStep)){
+                over = true;
+                break;
+            }
+            stepEvents |= simulation.Match().events;
+            nextStep += step;
+            ++steps;
+        }
+        if(nextStep <= now){
+            nextStep = now + step;
+        }
+        
+        if(steps > 0){
+            events.fetch_or(stepEvents, std::memory_order_relaxed);
+            
+            Snapshot& snapshot = snapshots.Back();
+            simulation.Capture(snapshot);
+            snapshot.stepTime = nextStep - step;
+            snapshots.Publish();
+        }
+        
+        if(over){
+            finished.store(true, std::memory_order_release);
+            return;
+        }
+        allocations.store(ThreadAllocations(), std::memory_order_relaxed);
+        std::this_thread::sleep_until(nextStep);
+    }
+}
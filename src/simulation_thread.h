@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "simulation.h"
+#include "triple_buffer.h"
+
+/*
+* Runs a Simulation on its own thread at the fixed step rate
+*   - The thread keeps its own clock, so a slow present, a vsync wait or a stalled
+*     compositor on the render thread never delays or bunches up simulation steps
+*   - The render thread hands over timestamped button changes through a lock-free queue
+*     and gets the state back as Snapshots through a lock-free triple buffer; neither side locks
+*   - Events are OR-ed into an atomic until the render thread takes them, so a sound
+*     isn't lost when the renderer skips a snapshot
+*/
+class SimulationThread{
+    public:
+        explicit SimulationThread(Simulation& simulation);
+        ~SimulationThread();
+        
+        SimulationThread(SimulationThread const&) = delete;
+        SimulationThread& operator=(SimulationThread const&) = delete;
+        
+        void Start();
+        void Stop();
+        
+        // A key change for the simulation to apply at the time it happened
+        void AddInput(ButtonChange const& change) { inputs.Push(change); }
+        
+        // Events of all steps since the last call
+        unsigned TakeEvents();
+        
+        // True once the simulation has ended by itself (a replay finished)
+        bool Finished() const { return finished.load(std::memory_order_acquire); }
+        
+        // The newest snapshot, valid until the next call
+        Snapshot const& Latest();
+        
+        // Heap allocations the simulation thread has made, as of its last wakeup
+        uint64_t Allocations() const { return allocations.load(std::memory_order_relaxed); }
+        
+    private:
+        void Run();
+        
+        Simulation& simulation;
+        std::thread thread;
+        std::atomic<bool> stopping{false};
+        std::atomic<bool> finished{false};
+        InputQueue inputs;
+        std::atomic<unsigned> events{0};
+        std::atomic<uint64_t> allocations{0};
+        TripleBuffer<Snapshot> snapshots;
+};
@@ -0,0 +1,81 @@
+#include "sound_board.h"
+
+SoundBoard::~SoundBoard(){
+    Close();
+}
+
+bool SoundBoard::Open(AudioSettings const& settings){
+    Close();
+    
+    // Take whatever rate the device runs at natively, so SDL doesn't resample in the audio callback
+    if(Mix_OpenAudioDevice(settings.frequency, AUDIO_S16SYS, 2, settings.bufferSamples, nullptr,
+                           SDL_AUDIO_ALLOW_FREQUENCY_CHANGE) != 0){
+        SDL_Log("Failed to open audio: %s", Mix_GetError());
+        return false;
+    }
+    open = true;
+    bufferSamples = settings.bufferSamples;
+    
+    Uint16 format;
+    int channels;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    
+    // One group of channels per effect, the group tag is the effect's index
+    const int sounds = static_cast<int>(Sound::Count);
+    const int voices = settings.voicesPerSound > 0 ? settings.voicesPerSound : 1;
+    Mix_AllocateChannels(sounds * voices);
+    for(int sound = 0; sound < sounds; ++sound){
+        Mix_GroupChannels(sound * voices, (sound + 1) * voices - 1, sound);
+    }
+    return true;
+}
+
+void SoundBoard::Close(){
+    if(!open){
+        return;
+    }
+    
+    // Chunks must not be freed while a channel may still be playing them
+    Mix_HaltChannel(-1);
+    for(Mix_Chunk*& chunk : chunks){
+        Mix_FreeChunk(chunk);
+        chunk = nullptr;
+    }
+    Mix_CloseAudio();
+    open = false;
+}
+
+bool SoundBoard::Load(Sound sound, const char* path){
+    if(!open){
+        return false;
+    }
+    
+    Mix_Chunk*& chunk = chunks[static_cast<int>(sound)];
+    Mix_FreeChunk(chunk);
+    chunk = Mix_LoadWAV(path);
+    if(!chunk){
+        SDL_Log("Failed to load sound %s: %s", path, Mix_GetError());
+        return false;
+    }
+    return true;
+}
+
+void SoundBoard::Play(Sound sound){
+    Mix_Chunk* chunk = chunks[static_cast<int>(sound)];
+    if(!chunk){
+        return;
+    }
+    
+    int group = static_cast<int>(sound);
+    int channel = Mix_GroupAvailable(group);
+    if(channel == -1){
+        channel = Mix_GroupOldest(group);
+    }
+    
+    // Starting a chunk on a busy channel replaces what it was playing
+    Mix_PlayChannel(channel, chunk, 0);
+}
+
+float SoundBoard::BufferMs() const{
+    return frequency > 0 ? 1000.0f * bufferSamples / frequency : 0.0f;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL_mixer.h>
+
+// The sound effects of the game
+enum class Sound{
+    PaddleHit,
+    WallHit,
+    Count
+};
+
+/*
+* Audio device settings
+*   - bufferSamples is the main source of audio latency: the mixer fills one buffer
+*     ahead, so a sound started now is heard up to bufferSamples / frequency later
+*     (256 samples at 48 kHz is about 5 ms, SDL_mixer's usual 2048 at 44.1 kHz about 46 ms)
+*   - Very small buffers can crackle on slow audio drivers, raise it there
+*/
+struct AudioSettings{
+    int frequency = 48000;
+    int bufferSamples = 256;
+    int voicesPerSound = 4;
+};
+
+/*
+* Plays the sound effects with a bounded, predictable cost per hit
+*   - Effects are loaded once after the device is open, which converts them to the
+*     device's format up front, so the mixer only copies and sums samples while playing
+*   - Each effect gets its own group of channels. A hit takes a free voice of its
+*     group, or restarts the group's oldest one if all are busy, so playing never
+*     searches all channels, never fails for lack of a voice, and a flood of one
+*     effect can't starve the other
+*/
+class SoundBoard{
+    public:
+        SoundBoard() = default;
+        ~SoundBoard();
+        
+        SoundBoard(SoundBoard const&) = delete;
+        SoundBoard& operator=(SoundBoard const&) = delete;
+        
+        // Opens the audio device, false (with the reason logged) if it can't
+        bool Open(AudioSettings const& settings);
+        void Close();
+        
+        bool Load(Sound sound, const char* path);
+        void Play(Sound sound);
+        
+        // Time a buffer of the opened device takes to play, in milliseconds
+        float BufferMs() const;
+        
+    private:
+        bool open = false;
+        int frequency = 0;
+        int bufferSamples = 0;
+        Mix_Chunk* chunks[static_cast<int>(Sound::Count)] = {};
+};
@@ -0,0 +1,136 @@
+#include "text_atlas.h"
+
+#include <initializer_list>
+
+// Glyph cells are laid out in a grid of this many columns
+static const int ATLAS_COLUMNS = 16;
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font) : renderer(renderer){
+    lineHeight = TTF_FontHeight(font);
+    
+    // Every cell is as wide as the widest glyph, which for a monospace font is all of them
+    int cellWidth = 1;
+    for(int i = 0; i < GLYPH_COUNT; ++i){
+        int advance = 0;
+        TTF_GlyphMetrics(font, static_cast<Uint16>(FIRST_GLYPH + i), nullptr, nullptr, nullptr, nullptr, &advance);
+        glyphs[i].advance = advance;
+        if(advance > cellWidth){
+            cellWidth = advance;
+        }
+    }
+    
+    int rows = (GLYPH_COUNT + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    textureWidth = ATLAS_COLUMNS * cellWidth;
+    textureHeight = rows * lineHeight;
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, textureWidth, textureHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    
+    /*
+    * Glyphs are rendered white, DrawText() tints them through the vertex color.
+    *   - TTF_RenderGlyph_Blended gives a surface one line high with the glyph placed
+    *     on the baseline, so cells can be copied out and drawn without any offset
+    */
+    for(int i = 0; i < GLYPH_COUNT; ++i){
+        SDL_Rect cell = {(i % ATLAS_COLUMNS) * cellWidth, (i / ATLAS_COLUMNS) * lineHeight, cellWidth, lineHeight};
+        glyphs[i].source = {cell.x, cell.y, glyphs[i].advance, lineHeight};
+        
+        SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(FIRST_GLYPH + i), {0xFF, 0xFF, 0xFF, 0xFF});
+        if(!glyph){
+            continue;
+        }
+        
+        // Copy the alpha channel as is instead of blending onto the empty atlas
+        SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyph, nullptr, atlas, &cell);
+        SDL_FreeSurface(glyph);
+    }
+    
+    texture = SDL_CreateTextureFromSurface(renderer, atlas);
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(atlas);
+    
+    // Room for a typical line of text up front
+    vertices.reserve(64 * 4);
+    indices.reserve(64 * 6);
+}
+
+GlyphAtlas::~GlyphAtlas(){
+    SDL_DestroyTexture(texture);
+}
+
+GlyphAtlas::Glyph const* GlyphAtlas::Find(char c) const{
+    if(c < FIRST_GLYPH || c > LAST_GLYPH){
+        return nullptr;
+    }
+    return &glyphs[c - FIRST_GLYPH];
+}
+
+int GlyphAtlas::TextWidth(const char* text) const{
+    int width = 0;
+    for(const char* c = text; *c; ++c){
+        if(Glyph const* glyph = Find(*c)){
+            width += glyph->advance;
+        }
+    }
+    return width;
+}
+
+void GlyphAtlas::DrawText(const char* text, int x, int y, SDL_Color color){
+    QueueText(text, x, y, color);
+    Flush();
+}
+
+void GlyphAtlas::QueueText(const char* text, int x, int y, SDL_Color color){
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    float u = 1.0f / textureWidth;
+    float v = 1.0f / textureHeight;
+    
+    // Two triangles per glyph
+    for(const char* c = text; *c; ++c){
+        Glyph const* glyph = Find(*c);
+        if(!glyph){
+            continue;
+        }
+        
+        SDL_Rect const& src = glyph->source;
+        float left = static_cast<float>(x);
+        float top = static_cast<float>(y);
+        float right = left + src.w;
+        float bottom = top + src.h;
+        
+        int first = static_cast<int>(vertices.size());
+        vertices.push_back({{left, top}, color, {src.x * u, src.y * v}});
+        vertices.push_back({{right, top}, color, {(src.x + src.w) * u, src.y * v}});
+        vertices.push_back({{right, bottom}, color, {(src.x + src.w) * u, (src.y + src.h) * v}});
+        vertices.push_back({{left, bottom}, color, {src.x * u, (src.y + src.h) * v}});
+        
+        for(int corner : {0, 1, 2, 0, 2, 3}){
+            indices.push_back(first + corner);
+        }
+        
+        x += glyph->advance;
+    }
+#else
+    // Without SDL_RenderGeometry, fall back to one copy per glyph out of the same texture right away
+    SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+    for(const char* c = text; *c; ++c){
+        Glyph const* glyph = Find(*c);
+        if(!glyph){
+            continue;
+        }
+        SDL_Rect dst = {x, y, glyph->source.w, glyph->source.h};
+        SDL_RenderCopy(renderer, texture, &glyph->source, &dst);
+        x += glyph->advance;
+    }
+#endif
+}
+
+void GlyphAtlas::Flush(){
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    if(!indices.empty()){
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+    }
+    vertices.clear();
+    indices.clear();
+#endif
+}
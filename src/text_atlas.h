@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+/*
+* Glyph atlas for one font at one size
+*   - Every printable ASCII glyph is rasterized once, when the atlas is created,
+*     into a single texture
+*   - Drawing a string only writes quads into buffers the atlas keeps between calls
+*     and submits them in one batch, so steady-state frames neither allocate nor
+*     upload textures
+*/
+class GlyphAtlas{
+    public:
+        GlyphAtlas(SDL_Renderer* renderer, TTF_Font* font);
+        ~GlyphAtlas();
+        
+        GlyphAtlas(GlyphAtlas const&) = delete;
+        GlyphAtlas& operator=(GlyphAtlas const&) = delete;
+        
+        // Draws `text` with its upper left corner at (x, y)
+        void DrawText(const char* text, int x, int y, SDL_Color color);
+        
+        /*
+        * Adds `text` to the pending batch instead of drawing it right away
+        *   - Flush() draws every queued string in one call
+        */
+        void QueueText(const char* text, int x, int y, SDL_Color color);
+        void Flush();
+        
+        // Size of the box DrawText() would fill
+        int TextWidth(const char* text) const;
+        int LineHeight() const { return lineHeight; }
+        
+    private:
+        static const char FIRST_GLYPH = ' ';
+        static const char LAST_GLYPH = '~';
+        static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+        
+        struct Glyph{
+            SDL_Rect source;
+            int advance;
+        };
+        
+        Glyph const* Find(char c) const;
+        
+        SDL_Renderer* renderer;
+        SDL_Texture* texture = nullptr;
+        int textureWidth = 0;
+        int textureHeight = 0;
+        int lineHeight = 0;
+        Glyph glyphs[GLYPH_COUNT];
+        
+        // Reused by every batch, they only grow when more text than before is queued
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+* Lock-free triple buffer for handing the latest value from one writer thread to one reader thread
+*   - The writer fills its own slot and publishes it, the reader takes the newest published
+*     slot; neither ever waits for the other, and the reader never sees a half-written value
+*   - Values published while the reader is busy are simply overwritten, only the newest counts
+*   - The third slot sits between the two, its index and a "fresh" bit share one atomic
+*/
+template<typename T>
+class TripleBuffer{
+    public:
+        // Writer: the slot to fill before the next Publish()
+        T& Back() { return slots[back].value; }
+        
+        // Writer: hands the filled slot over and takes the one in the middle
+        void Publish(){
+            back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX;
+        }
+        
+        // Reader: moves to the newest published value if there is one, true if it did
+        bool Update(){
+            if(!(middle.load(std::memory_order_relaxed) & FRESH)){
+                return false;
+            }
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+        
+        // Reader: the value taken by the last Update()
+        T const& Front() const { return slots[front].value; }
+        
+    private:
+        static const uint8_t INDEX = 0x3;
+        static const uint8_t FRESH = 0x4;
+        
+        // Each slot on its own cache line, so the two threads don't share one while writing
+        struct alignas(64) Slot{
+            T value;
+        };
+        
+        Slot slots[3];
+        std::atomic<uint8_t> middle{1};
+        uint8_t back = 0;
+        uint8_t front = 2;
+};
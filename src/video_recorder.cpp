@@ -0,0 +1,141 @@
+#include "video_recorder.h"
+
+#include <chrono>
+#include <initializer_list>
+
+// Fixed-point BT.601 studio range coefficients, scaled by 256
+static inline uint8_t Luma(int r, int g, int b){
+    return static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static inline uint8_t ChromaBlue(int r, int g, int b){
+    return static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+static inline uint8_t ChromaRed(int r, int g, int b){
+    return static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+void ArgbToI420(const uint32_t* argb, int width, int height, uint8_t* out){
+    uint8_t* lumaPlane = out;
+    uint8_t* bluePlane = out + width * height;
+    uint8_t* redPlane = bluePlane + (width / 2) * (height / 2);
+    
+    // Two rows at a time, so every 2x2 block is summed for its chroma sample in the same pass
+    for(int y = 0; y < height; y += 2){
+        const uint32_t* top = argb + y * width;
+        const uint32_t* bottom = top + width;
+        uint8_t* lumaTop = lumaPlane + y * width;
+        uint8_t* lumaBottom = lumaTop + width;
+        uint8_t* blue = bluePlane + (y / 2) * (width / 2);
+        uint8_t* red = redPlane + (y / 2) * (width / 2);
+        
+        for(int x = 0; x < width; x += 2){
+            int r = 0, g = 0, b = 0;
+            for(uint32_t pixel : {top[x], top[x + 1], bottom[x], bottom[x + 1]}){
+                r += (pixel >> 16) & 0xFF;
+                g += (pixel >> 8) & 0xFF;
+                b += pixel & 0xFF;
+            }
+            for(int i = 0; i < 2; ++i){
+                uint32_t upper = top[x + i];
+                uint32_t lower = bottom[x + i];
+                lumaTop[x + i] = Luma((upper >> 16) & 0xFF, (upper >> 8) & 0xFF, upper & 0xFF);
+                lumaBottom[x + i] = Luma((lower >> 16) & 0xFF, (lower >> 8) & 0xFF, lower & 0xFF);
+            }
+            blue[x / 2] = ChromaBlue(r / 4, g / 4, b / 4);
+            red[x / 2] = ChromaRed(r / 4, g / 4, b / 4);
+        }
+    }
+}
+
+VideoRecorder::~VideoRecorder(){
+    Close();
+}
+
+bool VideoRecorder::Open(const char* path, int width, int height, int fps){
+    Close();
+    file = std::fopen(path, "wb");
+    if(!file){
+        return false;
+    }
+    
+    /*
+    * Y4M stream header
+    *   - C420jpeg: 4:2:0 with each chroma sample centred on its 2x2 block, as ArgbToI420() averages them
+    *   - Ip: progressive, A1:1: square pixels
+    */
+    std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+    
+    this->width = width;
+    this->height = height;
+    pixels.assign(static_cast<std::size_t>(RING_FRAMES) * width * height, 0);
+    yuv.assign(static_cast<std::size_t>(width) * height * 3 / 2, 0);
+    captured.store(0);
+    written.store(0);
+    closing.store(false);
+    failed.store(false);
+    writer = std::thread(&VideoRecorder::Run, this);
+    return true;
+}
+
+bool VideoRecorder::Ready() const{
+    return IsOpen() && captured.load(std::memory_order_relaxed) - written.load(std::memory_order_acquire) < RING_FRAMES;
+}
+
+bool VideoRecorder::Capture(SDL_Renderer* renderer){
+    if(!Ready()){
+        return false;
+    }
+    
+    // The writer is done with this buffer, Ready() saw it advance past it
+    uint64_t index = captured.load(std::memory_order_relaxed);
+    if(SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888, Frame(index), width * 4) != 0){
+        return false;
+    }
+    captured.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+bool VideoRecorder::Close(){
+    if(!file){
+        return true;
+    }
+    
+    // The writer drains the ring before it exits
+    closing.store(true, std::memory_order_release);
+    if(writer.joinable()){
+        writer.join();
+    }
+    bool ok = !failed.load() && std::fclose(file) == 0;
+    file = nullptr;
+    return ok;
+}
+
+void VideoRecorder::Run(){
+    std::size_t frameBytes = yuv.size();
+    uint64_t next = written.load(std::memory_order_relaxed);
+    
+    for(;;){
+        // Read before checking for frames, so a frame captured right before Close() is still written
+        bool last = closing.load(std::memory_order_acquire);
+        
+        if(next == captured.load(std::memory_order_acquire)){
+            if(last){
+                return;
+            }
+            // Nothing queued, a frame takes milliseconds to draw anyway
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        
+        // After a failed write frames are still consumed, so the game never waits on a broken file
+        ArgbToI420(Frame(next), width, height, yuv.data());
+        if(!failed.load(std::memory_order_relaxed)){
+            if(std::fputs("FRAME\n", file) < 0 || std::fwrite(yuv.data(), 1, frameBytes, file) != frameBytes){
+                failed.store(true);
+            }
+        }
+        written.store(++next, std::memory_order_release);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <SDL2/SDL.h>
+
+/*
+* Converts one ARGB8888 frame to planar 4:2:0 YUV (BT.601, studio range)
+*   - `out` holds width*height luma bytes followed by the two quarter size chroma planes
+*   - Each chroma sample is the average of a 2x2 block, width and height must be even
+*/
+void ArgbToI420(const uint32_t* argb, int width, int height, uint8_t* out);
+
+/*
+* Records the frames the game draws to a Y4M video file
+*   - Capture() reads the renderer's target back into the next buffer of a fixed ring,
+*     a background thread converts the buffers to YUV and writes them in order
+*   - The game loop never touches the file; when the writer falls behind and the ring
+*     is full, Ready() is false and the caller decides to wait or skip the frame
+*   - All buffers are allocated by Open(), nothing is allocated per frame
+*   - The producer and the writer only share two frame counters, neither side locks
+*/
+class VideoRecorder{
+    public:
+        static const int RING_FRAMES = 8;
+        
+        VideoRecorder() = default;
+        ~VideoRecorder();
+        
+        VideoRecorder(VideoRecorder const&) = delete;
+        VideoRecorder& operator=(VideoRecorder const&) = delete;
+        
+        // Creates the file, writes the stream header and starts the writer, false if the file can't be created
+        bool Open(const char* path, int width, int height, int fps);
+        
+        bool IsOpen() const { return file != nullptr; }
+        
+        // Whether a ring buffer is free for the next Capture()
+        bool Ready() const;
+        
+        // Reads the current render target into a free buffer and queues it, false if none is free or the read failed
+        bool Capture(SDL_Renderer* renderer);
+        
+        // Writes the frames still queued and closes the file, false if any write failed
+        bool Close();
+        
+        uint64_t FramesWritten() const { return written.load(std::memory_order_acquire); }
+        
+    private:
+        void Run();
+        uint32_t* Frame(uint64_t index) { return pixels.data() + (index % RING_FRAMES) * width * height; }
+        
+        std::FILE* file = nullptr;
+        int width = 0;
+        int height = 0;
+        
+        // RING_FRAMES frames of width*height pixels, and the writer's YUV frame
+        std::vector<uint32_t> pixels;
+        std::vector<uint8_t> yuv;
+        
+        std::thread writer;
+        alignas(64) std::atomic<uint64_t> captured{0};
+        alignas(64) std::atomic<uint64_t> written{0};
+        std::atomic<bool> closing{false};
+        std::atomic<bool> failed{false};
+};
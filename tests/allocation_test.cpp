@@ -0,0 +1,82 @@
+/*
+* The frame arena
+*   - Scratch blocks freed within their frame never reach the heap, frame after frame
+*   - A block that outlives its frame is counted once, and the frames after it keep
+*     allocating scratch blocks from the arena instead of the heap
+*   - Once every chunk holds a live block, frames go to the heap, and come back to the
+*     arena as those blocks are freed
+*/
+#include <SDL2/SDL.h>
+
+#include "allocation_tracker.h"
+#include "check.h"
+
+// Does a frame's worth of scratch allocations, more in total than one chunk holds, the way SDL's renderer does
+static void ScratchFrame(){
+    for(int i = 0; i < 100; ++i){
+        void* rects = SDL_malloc(1024);
+        SDL_free(rects);
+    }
+    
+    // A buffer grown a few times, like the vertex data of a batch of draw calls
+    void* buffer = SDL_malloc(256);
+    for(std::size_t size = 512; size <= 8192; size *= 2){
+        buffer = SDL_realloc(buffer, size);
+    }
+    SDL_free(buffer);
+}
+
+int main(){
+    InstallAllocationHooks();
+    
+    BeginArenaFrame();
+    uint64_t heap = ThreadAllocations();
+    for(int frame = 0; frame < 100; ++frame){
+        BeginArenaFrame();
+        ScratchFrame();
+    }
+    CHECK(ThreadAllocations() == heap);
+    
+    // Kept past its frame, like a texture's pixels SDL holds on to
+    BeginArenaFrame();
+    void* kept = SDL_malloc(64);
+    ScratchFrame();
+    uint64_t served = ArenaAllocations();
+    for(int frame = 0; frame < 1000; ++frame){
+        BeginArenaFrame();
+        ScratchFrame();
+    }
+    CHECK(ThreadAllocations() == heap + 1);
+    CHECK(ArenaAllocations() - served == 1000 * (100 + 1));
+    SDL_free(kept);
+    
+    // One block kept in each frame until every chunk holds one, then scratch goes to the heap
+    const int KEPT = 64;
+    void* keptBlocks[KEPT] = {};
+    int keptCount = 0;
+    heap = ThreadAllocations();
+    for(; keptCount < KEPT; ++keptCount){
+        BeginArenaFrame();
+        served = ArenaAllocations();
+        keptBlocks[keptCount] = SDL_malloc(64);
+        if(ArenaAllocations() == served){
+            break;
+        }
+    }
+    CHECK(keptCount > 1 && keptCount < KEPT);
+    
+    // Each kept block counted once when its frame ended, then the one that found the arena full
+    CHECK(ThreadAllocations() == heap + keptCount + 1);
+    
+    for(int i = 0; i <= keptCount; ++i){
+        SDL_free(keptBlocks[i]);
+    }
+    heap = ThreadAllocations();
+    for(int frame = 0; frame < 100; ++frame){
+        BeginArenaFrame();
+        ScratchFrame();
+    }
+    CHECK(ThreadAllocations() == heap);
+    
+    return CheckFailures();
+}
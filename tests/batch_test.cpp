@@ -0,0 +1,69 @@
+/*
+* Batch equivalence
+*   - Every batch kernel this CPU runs must step each match exactly like pong::Step,
+*     bit for bit, over a long run of random inputs with plenty of hits and points
+*/
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "check.h"
+#include "core/batch.h"
+
+using namespace pong;
+
+// A count that isn't a multiple of the register width, so the tail is covered too
+static const std::size_t MATCHES = 67;
+static const int STEPS = 20000;
+
+static bool SameBits(float a, float b){
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+static bool SameMatch(GameState const& a, GameState const& b){
+    return SameBits(a.ball.position.x, b.ball.position.x) && SameBits(a.ball.position.y, b.ball.position.y) &&
+           SameBits(a.ball.velocity.x, b.ball.velocity.x) && SameBits(a.ball.velocity.y, b.ball.velocity.y) &&
+           SameBits(a.paddleLeft.position.y, b.paddleLeft.position.y) &&
+           SameBits(a.paddleRight.position.y, b.paddleRight.position.y) &&
+           a.leftScore == b.leftScore && a.rightScore == b.rightScore && a.events == b.events;
+}
+
+int main(){
+    for(BatchKernel kernel : {BatchKernel::Scalar, BatchKernel::SSE2, BatchKernel::AVX2}){
+        if(static_cast<int>(kernel) > static_cast<int>(BestBatchKernel())){
+            continue;
+        }
+        
+        std::mt19937 random(static_cast<uint32_t>(kernel) + 1);
+        BatchState batch = NewBatch(MATCHES);
+        std::vector<GameState> scalar(MATCHES, NewGame());
+        std::vector<Inputs> inputs(MATCHES);
+        
+        int firstMismatch = -1;
+        int points = 0;
+        for(int step = 0; step < STEPS && firstMismatch < 0; ++step){
+            for(std::size_t i = 0; i < MATCHES; ++i){
+                if(random() % 60 == 0){
+                    for(bool& button : inputs[i].buttons){
+                        button = (random() % 3) == 0;
+                    }
+                }
+                batch.buttons[i] = PackButtons(inputs[i]);
+                scalar[i] = Step(scalar[i], inputs[i], FIXED_DT);
+                points += (scalar[i].events & (EVENT_LEFT_SCORED | EVENT_RIGHT_SCORED)) != 0;
+            }
+            StepBatch(batch, FIXED_DT, kernel);
+            
+            for(std::size_t i = 0; i < MATCHES; ++i){
+                if(!SameMatch(GetMatch(batch, i), scalar[i])){
+                    std::fprintf(stderr, "%s: match %zu differs from pong::Step at step %d\n", BatchKernelName(kernel), i, step);
+                    firstMismatch = step;
+                    break;
+                }
+            }
+        }
+        CHECK(firstMismatch < 0);
+        CHECK(points > 0);
+    }
+    return CheckFailures();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdio>
+
+/*
+* The tests' only assertion
+*   - A failed CHECK prints where and what and is counted, the test goes on so one run
+*     shows every failure; main() returns CheckFailures() for CTest
+*/
+inline int& CheckFailures(){
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do{ \
+        if(!(condition)){ \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++CheckFailures(); \
+        } \
+    }while(0)
@@ -0,0 +1,113 @@
+/*
+* Replay round trips
+*   - A match recorded with ReplayWriter replays to the same footer, in every collision
+*     mode, in floats and in fixed point
+*   - Logs that are truncated or tampered with are rejected, not replayed
+*/
+#include <cstdio>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "check.h"
+#include "core/replay.h"
+
+using namespace pong;
+
+static const char* LOG_PATH = "replay_test.rpl";
+
+// Random held buttons, each held for a while like a player would
+static Inputs RandomInputs(std::mt19937& random, Inputs inputs, int& hold){
+    if(hold-- > 0){
+        return inputs;
+    }
+    for(bool& button : inputs.buttons){
+        button = (random() % 3) == 0;
+    }
+    hold = 10 + static_cast<int>(random() % 110);
+    return inputs;
+}
+
+template<typename T>
+static bool Record(CollisionMode mode, uint32_t seed, int steps){
+    ReplayHeader header;
+    header.mode = mode;
+    header.fixedPoint = std::is_same<T, Fixed>::value;
+    header.seed = seed;
+    ReplayWriter writer;
+    if(!writer.Open(LOG_PATH, header)){
+        return false;
+    }
+    
+    std::mt19937 random(seed);
+    BasicGameState<T> state = NewGame<T>();
+    Inputs inputs;
+    int hold = 0;
+    for(int step = 0; step < steps; ++step){
+        inputs = RandomInputs(random, inputs, hold);
+        writer.Record(inputs);
+        state = Step(state, inputs, Constants<T>::fixedDt, mode);
+    }
+    return writer.Finish(state);
+}
+
+static std::vector<unsigned char> ReadFile(const char* path){
+    std::vector<unsigned char> bytes;
+    if(std::FILE* file = std::fopen(path, "rb")){
+        int c;
+        while((c = std::fgetc(file)) != EOF){
+            bytes.push_back(static_cast<unsigned char>(c));
+        }
+        std::fclose(file);
+    }
+    return bytes;
+}
+
+static void WriteFile(const char* path, std::vector<unsigned char> const& bytes){
+    if(std::FILE* file = std::fopen(path, "wb")){
+        std::fwrite(bytes.data(), 1, bytes.size(), file);
+        std::fclose(file);
+    }
+}
+
+int main(){
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        CHECK(Record<float>(mode, 1, 20000));
+        ReplayResult floats = RunReplay(LOG_PATH);
+        CHECK(floats.ok);
+        CHECK(floats.steps == 20000);
+        
+        CHECK(Record<Fixed>(mode, 2, 20000));
+        ReplayReader reader;
+        CHECK(reader.Open(LOG_PATH) && reader.Header().fixedPoint && reader.Header().mode == mode && reader.Header().seed == 2);
+        ReplayResult fixed = RunReplay(LOG_PATH);
+        CHECK(fixed.ok);
+        CHECK(fixed.steps == 20000);
+    }
+    
+    // A different final state: the last byte is part of the footer's hash
+    std::vector<unsigned char> log = ReadFile(LOG_PATH);
+    if(log.size() < 64){
+        std::fprintf(stderr, "The recorded log is too short: %zu bytes\n", log.size());
+        return 1;
+    }
+    std::vector<unsigned char> tampered = log;
+    tampered[tampered.size() - 1] ^= 1;
+    WriteFile(LOG_PATH, tampered);
+    CHECK(!RunReplay(LOG_PATH).ok);
+    
+    // Cut off inside the header, after the magic
+    std::vector<unsigned char> truncated(log.begin(), log.begin() + 12);
+    WriteFile(LOG_PATH, truncated);
+    ReplayReader reader;
+    CHECK(!reader.Open(LOG_PATH));
+    CHECK(reader.Error() != nullptr);
+    
+    // Cut off inside the records
+    truncated.assign(log.begin(), log.begin() + log.size() / 2);
+    WriteFile(LOG_PATH, truncated);
+    CHECK(!RunReplay(LOG_PATH).ok);
+    
+    std::remove(LOG_PATH);
+    return CheckFailures();
+}
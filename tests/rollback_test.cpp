@@ -0,0 +1,64 @@
+/*
+* Rollback events
+*   - A paddle hit that only happens once the remote player's late input is known is
+*     reported when the rollback re-simulates it, even though no new step hits anything
+*   - Events are reported once: taking them again, or a rollback that changes nothing,
+*     reports nothing new
+*/
+#include "check.h"
+#include "core/rollback.h"
+
+using namespace pong;
+
+// Steps the remote player holds up for, then lets go, long enough to get the right paddle in front of the ball
+static const uint32_t UP_STEPS = 15;
+static const uint32_t STEPS = 80;
+
+static PlayerInput RemoteInput(uint32_t step){
+    return step < UP_STEPS ? 1 : 0;
+}
+
+int main(){
+    // The ball heads for the right paddle, passing just above it unless the paddle moves up
+    GameState start = NewGame();
+    start.ball.position = Vec2(start.paddleRight.position.x - 200.0f, start.paddleRight.position.y - 60.0f);
+    start.ball.velocity = Vec2(BALL_SPEED, 0.0f);
+    
+    unsigned predicted = EVENT_NONE;
+    unsigned actual = EVENT_NONE;
+    GameState still = start;
+    GameState moving = start;
+    for(uint32_t step = 0; step < STEPS; ++step){
+        still = Step(still, CombineInputs(0, 0), FIXED_DT);
+        moving = Step(moving, CombineInputs(0, RemoteInput(step)), FIXED_DT);
+        predicted |= still.events;
+        actual |= moving.events;
+    }
+    CHECK(!(predicted & EVENT_PADDLE_HIT));
+    CHECK(actual & EVENT_PADDLE_HIT);
+    
+    // The left player runs ahead on the prediction that the right paddle stays put
+    RollbackSession session(0, start);
+    for(uint32_t step = 0; step < STEPS; ++step){
+        session.Advance(0);
+    }
+    CHECK(session.TakeEvents() == predicted);
+    CHECK(session.TakeEvents() == EVENT_NONE);
+    
+    // The real inputs arrive and the hit turns up in the corrected steps
+    for(uint32_t step = 0; step < STEPS; ++step){
+        session.AddRemoteInput(step, RemoteInput(step));
+    }
+    session.Resolve();
+    CHECK(session.State().ball.velocity.x < 0.0f);
+    CHECK(session.TakeEvents() & EVENT_PADDLE_HIT);
+    CHECK(session.TakeEvents() == EVENT_NONE);
+    
+    // Inputs that match what was simulated don't roll anything back or report anything again
+    session.AddRemoteInput(STEPS, 0);
+    session.Advance(0);
+    CHECK(session.Stats().rollbacks == 1);
+    CHECK(!(session.TakeEvents() & EVENT_PADDLE_HIT));
+    
+    return CheckFailures();
+}
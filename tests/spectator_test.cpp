@@ -0,0 +1,93 @@
+/*
+* Spectator codec
+*   - Keyframes and deltas decode back to exactly the quantized state
+*   - A client that missed deltas still decodes the next one it gets against its keyframe,
+*     and one that joined after a keyframe can't decode anything until the next
+*   - Dequantize(Quantize()) is within the quantization step
+*   - The screen the host shows goes through keyframes and deltas like any other field
+*/
+#include <cmath>
+#include <random>
+
+#include "check.h"
+#include "net/spectator.h"
+
+using namespace pong;
+
+static bool SameState(SpectatorState const& a, SpectatorState const& b){
+    if(a.tick != b.tick){
+        return false;
+    }
+    for(int field = 0; field < SpectatorState::FieldCount; ++field){
+        if(a.fields[field] != b.fields[field]){
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(){
+    std::mt19937 random(5);
+    GameState match = NewGame();
+    Inputs inputs;
+    
+    SpectatorDecoder every;
+    SpectatorDecoder sometimes;
+    SpectatorDecoder late;
+    SpectatorState keyframe;
+    uint8_t message[MAX_SPECTATOR_MESSAGE];
+    int decoded = 0;
+    
+    for(uint32_t tick = 0; tick < 5000; ++tick){
+        if(random() % 60 == 0){
+            for(bool& button : inputs.buttons){
+                button = (random() % 3) == 0;
+            }
+        }
+        match = Step(match, inputs, FIXED_DT);
+        SpectatorState state = Quantize(match, tick);
+        
+        bool isKeyframe = tick % SpectatorServer::KEYFRAME_INTERVAL == 0;
+        std::size_t size = isKeyframe ? EncodeKeyframe(state, message) : EncodeDelta(keyframe, state, message);
+        if(isKeyframe){
+            keyframe = state;
+        }
+        CHECK(size <= MAX_SPECTATOR_MESSAGE);
+        CHECK(message[0] == size - 1);
+        
+        SpectatorState out;
+        CHECK(every.Decode(message + 1, size - 1, out) && SameState(out, state));
+        
+        // Misses nine deltas in ten; the server never sends a delta to a client without its keyframe
+        if(isKeyframe || tick % 10 == 3){
+            if(sometimes.Decode(message + 1, size - 1, out)){
+                CHECK(SameState(out, state));
+                ++decoded;
+            }
+        }
+        
+        // Joins after the first keyframe, so its first decodable message is the second keyframe
+        if(tick > 0){
+            bool ok = late.Decode(message + 1, size - 1, out);
+            CHECK(ok == (tick >= SpectatorServer::KEYFRAME_INTERVAL));
+        }
+        
+        GameState back = Dequantize(state);
+        CHECK(std::fabs(back.ball.position.x - match.ball.position.x) <= 1.0f / 16.0f);
+        CHECK(std::fabs(back.ball.position.y - match.ball.position.y) <= 1.0f / 16.0f);
+        CHECK(back.leftScore == match.leftScore && back.rightScore == match.rightScore);
+    }
+    CHECK(decoded > 0);
+    
+    // A host on its start screen, then the first step of play as a delta against it
+    SpectatorDecoder watcher;
+    SpectatorState waiting = Quantize(NewGame(), 0, SPECTATOR_START_SCREEN);
+    SpectatorState playing = Quantize(Step(NewGame(), Inputs(), FIXED_DT), 1);
+    SpectatorState out;
+    std::size_t size = EncodeKeyframe(waiting, message);
+    CHECK(watcher.Decode(message + 1, size - 1, out) && out.fields[SpectatorState::Screen] == SPECTATOR_START_SCREEN);
+    size = EncodeDelta(waiting, playing, message);
+    CHECK(watcher.Decode(message + 1, size - 1, out) && out.fields[SpectatorState::Screen] == SPECTATOR_PLAYING);
+    
+    return CheckFailures();
+}
@@ -0,0 +1,69 @@
+/*
+* Swept collisions
+*   - A ball fast enough to cross a paddle within one step tunnels through it with
+*     discrete checks and must bounce with swept ones
+*   - A paddle moving onto the ball bounces it in both modes
+*   - Over a long random match both modes keep the ball inside the field
+*/
+#include <random>
+
+#include "check.h"
+#include "core/game.h"
+
+using namespace pong;
+
+// The left paddle's front face, where a ball bouncing off it ends up on the right of
+static float LeftFace(GameState const& state){
+    return state.paddleLeft.position.x + PADDLE_WIDTH;
+}
+
+int main(){
+    Inputs none;
+    
+    // 40 px per millisecond crosses the paddle and the ball's own width several times over in a step
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        GameState state = NewGame();
+        state.ball.position = Vec2(LeftFace(state) + 20.0f, state.paddleLeft.position.y + 40.0f);
+        state.ball.velocity = Vec2(-40.0f, 0.0f);
+        state = Step(state, none, FIXED_DT, mode);
+        
+        bool bounced = state.ball.velocity.x > 0.0f && (state.events & EVENT_PADDLE_HIT);
+        CHECK(bounced == (mode == CollisionMode::Swept));
+        if(mode == CollisionMode::Swept){
+            CHECK(state.ball.position.x >= LeftFace(state));
+        }
+    }
+    
+    // The paddle moves down onto a ball that is already level with its front face
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        GameState state = NewGame();
+        state.paddleLeft.position.y = 280.0f;
+        state.ball.position = Vec2(state.paddleLeft.position.x + 2.0f, 286.0f);
+        state.ball.velocity = Vec2(-1.0f, 0.0f);
+        
+        Inputs down;
+        down.buttons[PaddleLeftDown] = true;
+        state = Step(state, down, FIXED_DT, mode);
+        CHECK(state.ball.velocity.x > 0.0f);
+        CHECK(state.events & EVENT_PADDLE_HIT);
+    }
+    
+    // A long match with random paddles never leaves the ball outside the field
+    for(CollisionMode mode : {CollisionMode::Discrete, CollisionMode::Swept}){
+        std::mt19937 random(3);
+        GameState state = NewGame();
+        Inputs inputs;
+        bool inside = true;
+        for(int step = 0; step < 50000; ++step){
+            if(random() % 60 == 0){
+                for(bool& button : inputs.buttons){
+                    button = (random() % 3) == 0;
+                }
+            }
+            state = Step(state, inputs, FIXED_DT, mode);
+            inside = inside && state.ball.position.y >= -1.0f && state.ball.position.y + BALL_HEIGHT <= WINDOW_HEIGHT + 1.0f;
+        }
+        CHECK(inside);
+    }
+    return CheckFailures();
+}
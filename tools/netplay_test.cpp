@@ -0,0 +1,147 @@
+/*
+* Headless netplay soak test
+*   - Runs a host and a client in one process, talking over localhost UDP with
+*     simulated delay, jitter and loss, each pressing random buttons
+*   - Time is virtual, so a long match with bad network conditions runs in well under a second
+*   - Once both peers have every input, their states must hash the same; exits with 1 if not
+*
+* Usage: pong_netplay_test [--steps=N] [--delay=MS] [--jitter=MS] [--loss=PCT] [--seed=N]
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "core/replay.h"
+#include "net/netplay.h"
+
+static const char* OptionValue(const char* arg, const char* name){
+    std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0 && arg[length] == '='){
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+// Holds a random input for a random number of steps, roughly like a player would
+struct ScriptedPlayer{
+    std::mt19937 random;
+    pong::PlayerInput input = 0;
+    int holdSteps = 0;
+    
+    explicit ScriptedPlayer(uint32_t seed) : random(seed) {}
+    
+    pong::PlayerInput Next(){
+        if(holdSteps-- <= 0){
+            input = static_cast<pong::PlayerInput>(std::uniform_int_distribution<int>(0, 2)(random));
+            holdSteps = std::uniform_int_distribution<int>(10, 120)(random);
+        }
+        return input;
+    }
+};
+
+static void PrintStats(const char* name, pong::Netplay const& peer){
+    pong::RollbackStats const& rollback = peer.Session().Stats();
+    pong::NetplayStats const& net = peer.Stats();
+    std::printf("%s  rollbacks %llu  resimulated %llu steps  deepest %u  stalled %llu  sent %llu  received %llu\n", name,
+                static_cast<unsigned long long>(rollback.rollbacks), static_cast<unsigned long long>(rollback.resimulatedSteps),
+                rollback.deepestRollback, static_cast<unsigned long long>(net.stalledSteps),
+                static_cast<unsigned long long>(net.packetsSent), static_cast<unsigned long long>(net.packetsReceived));
+}
+
+int main(int argc, char* argv[]){
+    uint32_t steps = 20000;
+    pong::LinkConditions conditions;
+    conditions.delayMs = 50.0;
+    conditions.jitterMs = 20.0;
+    conditions.lossPercent = 5.0;
+    
+    for(int i = 1; i < argc; ++i){
+        const char* value;
+        if((value = OptionValue(argv[i], "--steps"))){
+            steps = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }else if((value = OptionValue(argv[i], "--delay"))){
+            conditions.delayMs = std::atof(value);
+        }else if((value = OptionValue(argv[i], "--jitter"))){
+            conditions.jitterMs = std::atof(value);
+        }else if((value = OptionValue(argv[i], "--loss"))){
+            conditions.lossPercent = std::atof(value);
+        }else if((value = OptionValue(argv[i], "--seed"))){
+            conditions.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }else{
+            std::fprintf(stderr, "Usage: %s [--steps=N] [--delay=MS] [--jitter=MS] [--loss=PCT] [--seed=N]\n", argv[0]);
+            return 2;
+        }
+    }
+    
+    pong::NetplayConfig hostConfig;
+    hostConfig.host = true;
+    hostConfig.conditions = conditions;
+    pong::Netplay host(hostConfig);
+    if(!host.Start()){
+        std::fprintf(stderr, "Could not open the host socket\n");
+        return 2;
+    }
+    
+    pong::NetplayConfig clientConfig;
+    clientConfig.host = false;
+    clientConfig.remoteHost = "127.0.0.1";
+    clientConfig.remotePort = host.LocalPort();
+    clientConfig.conditions = conditions;
+    clientConfig.conditions.seed = conditions.seed + 1;
+    pong::Netplay client(clientConfig);
+    if(!client.Start()){
+        std::fprintf(stderr, "Could not open the client socket\n");
+        return 2;
+    }
+    
+    ScriptedPlayer hostPlayer(conditions.seed * 2654435761u);
+    ScriptedPlayer clientPlayer(conditions.seed * 2246822519u);
+    
+    // Both peers run at the fixed step rate, the client starts a little later like it would for real
+    double now = 0.0;
+    double clientStart = 37.0;
+    
+    // Enough time to finish with stalls, plus a couple of seconds to deliver the last inputs
+    double deadline = steps * pong::FIXED_DT * 4.0 + 2000.0 + conditions.delayMs * 10.0;
+    
+    while(now < deadline){
+        host.Poll(now);
+        if(now >= clientStart){
+            client.Poll(now);
+        }
+        
+        if(host.Session().Frame() < steps && host.Step(hostPlayer.input, now)){
+            hostPlayer.Next();
+        }
+        if(now >= clientStart && client.Session().Frame() < steps && client.Step(clientPlayer.input, now)){
+            clientPlayer.Next();
+        }
+        
+        if(host.Session().ConfirmedFrame() >= steps && client.Session().ConfirmedFrame() >= steps &&
+           host.Session().Frame() >= steps && client.Session().Frame() >= steps){
+            break;
+        }
+        now += pong::FIXED_DT;
+    }
+    
+    PrintStats("host  ", host);
+    PrintStats("client", client);
+    
+    if(host.Session().ConfirmedFrame() < steps || client.Session().ConfirmedFrame() < steps){
+        std::printf("FAIL  only confirmed %u and %u of %u steps\n", host.Session().ConfirmedFrame(),
+                    client.Session().ConfirmedFrame(), steps);
+        return 1;
+    }
+    
+    uint64_t hostHash = pong::HashState(host.State());
+    uint64_t clientHash = pong::HashState(client.State());
+    if(hostHash != clientHash){
+        std::printf("FAIL  states differ after %u steps: %016llx vs %016llx\n", steps,
+                    static_cast<unsigned long long>(hostHash), static_cast<unsigned long long>(clientHash));
+        return 1;
+    }
+    std::printf("ok    %u steps  %d-%d  hash %016llx\n", steps, host.State().leftScore, host.State().rightScore,
+                static_cast<unsigned long long>(hostHash));
+    return 0;
+}
@@ -0,0 +1,44 @@
+/*
+* Headless replay checker
+*   - Replays each log given on the command line as fast as possible, without SDL,
+*     and checks the final scores and state hash against the recording
+*   - Exits with 1 if any log doesn't reproduce, so it can gate physics changes
+*     against an archive of recorded matches
+*
+* Usage: pong_replay LOG...
+*/
+#include <chrono>
+#include <cstdio>
+
+#include "core/replay.h"
+
+int main(int argc, char* argv[]){
+    if(argc < 2){
+        std::fprintf(stderr, "Usage: %s LOG...\n", argv[0]);
+        return 2;
+    }
+    
+    int failed = 0;
+    unsigned long long totalSteps = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    for(int i = 1; i < argc; ++i){
+        pong::ReplayResult result = pong::RunReplay(argv[i]);
+        totalSteps += result.steps;
+        
+        if(result.ok){
+            std::printf("ok    %s  %llu steps  %d-%d\n", argv[i], static_cast<unsigned long long>(result.steps),
+                        result.final.leftScore, result.final.rightScore);
+        }else{
+            ++failed;
+            std::printf("FAIL  %s  %s (replayed %d-%d after %llu steps, recorded %d-%d after %llu)\n", argv[i], result.error.c_str(),
+                        result.final.leftScore, result.final.rightScore, static_cast<unsigned long long>(result.steps),
+                        result.expected.leftScore, result.expected.rightScore, static_cast<unsigned long long>(result.expected.steps));
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%d of %d logs reproduced, %llu steps in %.3f s (%.0f steps/s)\n", argc - 1 - failed, argc - 1,
+                totalSteps, seconds, seconds > 0.0 ? totalSteps / seconds : 0.0);
+    return failed == 0 ? 0 : 1;
+}
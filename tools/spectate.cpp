@@ -0,0 +1,92 @@
+/*
+* Watches a match served with pong --spectators, like a stat collector would
+*   - Prints every goal, every change between the host's start screen and play, and the
+*     ball and paddles every N ticks
+*   - On disconnect prints how many ticks arrived, how many were skipped
+*     (the server drops messages for a spectator that reads too slowly) and the bytes per tick
+*
+* Usage: pong_spectate HOST:PORT|unix:PATH [--every=N]
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "net/spectator.h"
+
+static const char* OptionValue(const char* arg, const char* name){
+    std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0 && arg[length] == '='){
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+int main(int argc, char* argv[]){
+    const char* address = nullptr;
+    uint32_t every = 240;
+    
+    for(int i = 1; i < argc; ++i){
+        const char* value;
+        if((value = OptionValue(argv[i], "--every"))){
+            every = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }else if(argv[i][0] != '-' && !address){
+            address = argv[i];
+        }else{
+            address = nullptr;
+            break;
+        }
+    }
+    if(!address){
+        std::fprintf(stderr, "Usage: %s HOST:PORT|unix:PATH [--every=N]\n", argv[0]);
+        return 2;
+    }
+    
+    pong::SpectatorClient client;
+    if(!client.Connect(address)){
+        std::fprintf(stderr, "Could not connect to %s\n", address);
+        return 1;
+    }
+    
+    pong::SpectatorState state;
+    uint64_t received = 0;
+    uint64_t skipped = 0;
+    uint32_t firstTick = 0;
+    uint32_t lastTick = 0;
+    int leftScore = -1;
+    int rightScore = -1;
+    int32_t screen = -1;
+    while(client.Next(state)){
+        if(received == 0){
+            firstTick = state.tick;
+        }else if(state.tick > lastTick + 1){
+            skipped += state.tick - lastTick - 1;
+        }
+        ++received;
+        lastTick = state.tick;
+        
+        if(state.fields[pong::SpectatorState::Screen] != screen){
+            screen = state.fields[pong::SpectatorState::Screen];
+            std::printf("tick %8u  %s\n", state.tick, screen == pong::SPECTATOR_START_SCREEN ? "start screen" : "playing");
+        }
+        
+        pong::GameState match = pong::Dequantize(state);
+        if(match.leftScore != leftScore || match.rightScore != rightScore){
+            leftScore = match.leftScore;
+            rightScore = match.rightScore;
+            std::printf("tick %8u  score %d-%d\n", state.tick, leftScore, rightScore);
+        }else if(every > 0 && state.tick % every == 0){
+            std::printf("tick %8u  ball %7.2f %7.2f  paddles %7.2f %7.2f\n", state.tick, match.ball.position.x,
+                        match.ball.position.y, match.paddleLeft.position.y, match.paddleRight.position.y);
+        }
+        std::fflush(stdout);
+    }
+    
+    if(received == 0){
+        std::printf("No states received\n");
+        return 1;
+    }
+    std::printf("Received %llu ticks (%u to %u), skipped %llu, %.1f bytes per tick\n",
+                static_cast<unsigned long long>(received), firstTick, lastTick, static_cast<unsigned long long>(skipped),
+                static_cast<double>(client.BytesReceived()) / static_cast<double>(received));
+    return 0;
+}
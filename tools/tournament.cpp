@@ -0,0 +1,411 @@
+/*
+* Headless tournament runner
+*   - Plays computer-vs-computer matches as fast as the CPU allows, on every core, to
+*     balance the rules without sitting through matches in a window
+*   - Sweeps the ball speed, paddle speed and paddle height, and pairs every computer
+*     profile with every other one; each combination is a config that plays --matches matches
+*   - Matches are shared out by work stealing: every worker owns a range of matches and
+*     takes from its front, a worker that runs out steals the back half of another's range
+*   - Every worker adds its results up on its own, the totals are only combined once the
+*     workers are done, so nothing is locked while matches run
+*
+* Usage: pong_tournament [--ball-speed=LIST] [--paddle-speed=LIST] [--paddle-height=LIST]
+*                        [--ai=LIST] [--matches=N] [--points=N] [--max-minutes=N]
+*                        [--threads=N] [--seed=N] [--swept]
+*   LIST is comma separated, e.g. --ball-speed=0.8,1,1.2
+*   A computer profile is REACTION_MS:ERROR_PX, e.g. --ai=150:80,80:100
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "core/ai.h"
+#include "core/game.h"
+
+static const char* OptionValue(const char* arg, const char* name){
+    std::size_t length = std::strlen(name);
+    if(std::strncmp(arg, name, length) == 0 && arg[length] == '='){
+        return arg + length + 1;
+    }
+    return nullptr;
+}
+
+// Parses "a,b,c", false if any item isn't a positive number
+static bool ParseList(const char* value, std::vector<float>& list){
+    list.clear();
+    while(*value){
+        char* end;
+        float item = std::strtof(value, &end);
+        if(end == value || item <= 0.0f || (*end != ',' && *end != '\0')){
+            return false;
+        }
+        list.push_back(item);
+        value = (*end == ',') ? end + 1 : end;
+    }
+    return !list.empty();
+}
+
+// Parses "reaction:error,reaction:error"
+static bool ParseProfiles(const char* value, std::vector<pong::AiSettings>& profiles){
+    profiles.clear();
+    while(*value){
+        char* end;
+        pong::AiSettings profile;
+        profile.reactionMs = std::strtof(value, &end);
+        if(end == value || *end != ':'){
+            return false;
+        }
+        value = end + 1;
+        profile.errorPx = std::strtof(value, &end);
+        if(end == value || profile.reactionMs < 0.0f || profile.errorPx < 0.0f || (*end != ',' && *end != '\0')){
+            return false;
+        }
+        profiles.push_back(profile);
+        value = (*end == ',') ? end + 1 : end;
+    }
+    return !profiles.empty();
+}
+
+// One combination of rules and computer players
+struct Config{
+    pong::Rules rules;
+    pong::AiSettings left;
+    pong::AiSettings right;
+};
+
+/*
+* What one worker has seen of one config
+*   - A rally is the paddle hits from a serve to the point it ends in, or to the time
+*     limit for the rally a drawn match is cut off in, which counts as a rally too
+*/
+struct Tally{
+    uint64_t matches = 0;
+    uint64_t leftWins = 0;
+    uint64_t rightWins = 0;
+    uint64_t draws = 0;
+    uint64_t points = 0;
+    uint64_t rallies = 0;
+    uint64_t rallyHits = 0;
+    uint64_t rallySteps = 0;
+    uint64_t longestRally = 0;
+    uint64_t steps = 0;
+    
+    void Add(Tally const& other){
+        matches += other.matches;
+        leftWins += other.leftWins;
+        rightWins += other.rightWins;
+        draws += other.draws;
+        points += other.points;
+        rallies += other.rallies;
+        rallyHits += other.rallyHits;
+        rallySteps += other.rallySteps;
+        longestRally = std::max(longestRally, other.longestRally);
+        steps += other.steps;
+    }
+};
+
+/*
+* The matches still to play, as one [begin, end) range of match numbers per worker
+*   - A range is packed into one 64-bit atomic, begin in the low half, so taking a
+*     match or stealing half of a range is a single compare-and-swap
+*   - Only the owner takes from the front, thieves cut off the back, and a range is
+*     only stored to by its owner once it is empty, when no thief will touch it
+*/
+class WorkRanges{
+    public:
+        WorkRanges(uint32_t jobs, int workers) : ranges(workers){
+            for(int i = 0; i < workers; ++i){
+                uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(jobs) * i / workers);
+                uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(jobs) * (i + 1) / workers);
+                ranges[i].range.store(Pack(begin, end), std::memory_order_relaxed);
+            }
+        }
+        
+        // Takes the next match of `worker`'s own range
+        bool Take(int worker, uint32_t& job){
+            std::atomic<uint64_t>& range = ranges[worker].range;
+            uint64_t current = range.load(std::memory_order_acquire);
+            while(Begin(current) < End(current)){
+                if(range.compare_exchange_weak(current, Pack(Begin(current) + 1, End(current)), std::memory_order_acq_rel)){
+                    job = Begin(current);
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        // Steals the back half of the first other range with work left, keeps one match and stores the rest as its own
+        bool Steal(int worker, uint32_t& job){
+            int count = static_cast<int>(ranges.size());
+            for(int offset = 1; offset < count; ++offset){
+                std::atomic<uint64_t>& victim = ranges[(worker + offset) % count].range;
+                uint64_t current = victim.load(std::memory_order_acquire);
+                while(Begin(current) < End(current)){
+                    uint32_t size = End(current) - Begin(current);
+                    uint32_t split = End(current) - (size + 1) / 2;
+                    if(victim.compare_exchange_weak(current, Pack(Begin(current), split), std::memory_order_acq_rel)){
+                        ranges[worker].range.store(Pack(split + 1, End(current)), std::memory_order_release);
+                        job = split;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+        
+    private:
+        static uint64_t Pack(uint32_t begin, uint32_t end){ return (static_cast<uint64_t>(end) << 32) | begin; }
+        static uint32_t Begin(uint64_t range){ return static_cast<uint32_t>(range); }
+        static uint32_t End(uint64_t range){ return static_cast<uint32_t>(range >> 32); }
+        
+        // Each range on its own cache line, so taking from one doesn't slow down the others
+        struct alignas(64) Range{
+            std::atomic<uint64_t> range{0};
+        };
+        std::vector<Range> ranges;
+};
+
+// Everything a worker writes while it runs, kept apart from the other workers'
+struct alignas(64) Worker{
+    std::vector<Tally> tallies;
+    uint64_t steals = 0;
+};
+
+struct Settings{
+    int matchesPerConfig = 100;
+    int points = 11;
+    uint64_t maxSteps = static_cast<uint64_t>(10 * 60 * 1000 / pong::FIXED_DT);
+    uint32_t seed = 1;
+    pong::CollisionMode mode = pong::CollisionMode::Discrete;
+};
+
+// A different, well mixed seed for every match and side (splitmix32)
+static uint32_t MatchSeed(uint32_t seed, uint32_t job, uint32_t side){
+    uint32_t x = seed + job * 0x9E3779B9u + side * 0x85EBCA6Bu;
+    x = (x ^ (x >> 16)) * 0x21F0AAADu;
+    x = (x ^ (x >> 15)) * 0x735A2D97u;
+    x ^= x >> 15;
+    return x ? x : 1;
+}
+
+static void PlayMatch(Config const& config, Settings const& settings, uint32_t job, Tally& tally){
+    pong::AiSettings leftSettings = config.left;
+    pong::AiSettings rightSettings = config.right;
+    leftSettings.seed = MatchSeed(settings.seed, job, 0);
+    rightSettings.seed = MatchSeed(settings.seed, job, 1);
+    pong::PaddleAi left(0, leftSettings);
+    pong::PaddleAi right(1, rightSettings);
+    
+    pong::GameState state = pong::NewGame(config.rules);
+    pong::Inputs inputs;
+    uint64_t steps = 0;
+    uint64_t rally = 0;
+    uint64_t rallySteps = 0;
+    
+    while(state.leftScore < settings.points && state.rightScore < settings.points && steps < settings.maxSteps){
+        left.Drive(state, pong::FIXED_DT, inputs);
+        right.Drive(state, pong::FIXED_DT, inputs);
+        state = pong::Step(state, inputs, pong::FIXED_DT, settings.mode);
+        ++steps;
+        ++rallySteps;
+        
+        if(state.events & pong::EVENT_PADDLE_HIT){
+            ++rally;
+        }
+        if(state.events & (pong::EVENT_LEFT_SCORED | pong::EVENT_RIGHT_SCORED)){
+            ++tally.points;
+            ++tally.rallies;
+            tally.rallyHits += rally;
+            tally.rallySteps += rallySteps;
+            tally.longestRally = std::max(tally.longestRally, rally);
+            rally = 0;
+            rallySteps = 0;
+        }
+    }
+    
+    // The rally the time limit cut off
+    if(rallySteps > 0){
+        ++tally.rallies;
+        tally.rallyHits += rally;
+        tally.rallySteps += rallySteps;
+        tally.longestRally = std::max(tally.longestRally, rally);
+    }
+    
+    ++tally.matches;
+    tally.steps += steps;
+    if(state.leftScore > state.rightScore){
+        ++tally.leftWins;
+    }else if(state.rightScore > state.leftScore){
+        ++tally.rightWins;
+    }else{
+        ++tally.draws;
+    }
+}
+
+static void PrintUsage(const char* program){
+    std::fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --ball-speed=LIST      Ball speeds to sweep (default %g)\n"
+        "  --paddle-speed=LIST    Paddle speeds to sweep (default %g)\n"
+        "  --paddle-height=LIST   Paddle heights to sweep (default %d)\n"
+        "  --ai=LIST              Computer profiles REACTION_MS:ERROR_PX, every pair plays (default 150:80)\n"
+        "  --matches=N            Matches per config (default 100)\n"
+        "  --points=N             Points to win a match (default 11)\n"
+        "  --max-minutes=N        Game time after which a match is a draw (default 10)\n"
+        "  --threads=N            Worker threads (default one per core)\n"
+        "  --seed=N               Seed of the computer players' aim errors (default 1)\n"
+        "  --swept                Use swept collisions instead of discrete ones\n",
+        program, pong::BALL_SPEED, pong::PADDLE_SPEED, pong::PADDLE_HEIGHT);
+}
+
+int main(int argc, char* argv[]){
+    std::vector<float> ballSpeeds = {pong::BALL_SPEED};
+    std::vector<float> paddleSpeeds = {pong::PADDLE_SPEED};
+    std::vector<float> paddleHeights = {static_cast<float>(pong::PADDLE_HEIGHT)};
+    std::vector<pong::AiSettings> profiles = {pong::AiSettings{}};
+    Settings settings;
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    
+    for(int i = 1; i < argc; ++i){
+        const char* value;
+        bool ok = true;
+        if((value = OptionValue(argv[i], "--ball-speed"))){
+            ok = ParseList(value, ballSpeeds);
+        }else if((value = OptionValue(argv[i], "--paddle-speed"))){
+            ok = ParseList(value, paddleSpeeds);
+        }else if((value = OptionValue(argv[i], "--paddle-height"))){
+            ok = ParseList(value, paddleHeights);
+        }else if((value = OptionValue(argv[i], "--ai"))){
+            ok = ParseProfiles(value, profiles);
+        }else if((value = OptionValue(argv[i], "--matches"))){
+            settings.matchesPerConfig = std::atoi(value);
+            ok = settings.matchesPerConfig > 0;
+        }else if((value = OptionValue(argv[i], "--points"))){
+            settings.points = std::atoi(value);
+            ok = settings.points > 0;
+        }else if((value = OptionValue(argv[i], "--max-minutes"))){
+            double minutes = std::atof(value);
+            settings.maxSteps = static_cast<uint64_t>(minutes * 60.0 * 1000.0 / pong::FIXED_DT);
+            ok = minutes > 0.0;
+        }else if((value = OptionValue(argv[i], "--threads"))){
+            threads = std::atoi(value);
+            ok = threads > 0;
+        }else if((value = OptionValue(argv[i], "--seed"))){
+            settings.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }else if(std::strcmp(argv[i], "--swept") == 0){
+            settings.mode = pong::CollisionMode::Swept;
+        }else{
+            ok = false;
+        }
+        if(!ok){
+            std::fprintf(stderr, "Invalid argument: %s\n", argv[i]);
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+    threads = std::max(threads, 1);
+    
+    for(float height : paddleHeights){
+        if(height >= pong::WINDOW_HEIGHT){
+            std::fprintf(stderr, "A paddle must be shorter than the field: %g\n", height);
+            return 2;
+        }
+    }
+    
+    std::vector<Config> configs;
+    for(float ballSpeed : ballSpeeds){
+        for(float paddleSpeed : paddleSpeeds){
+            for(float paddleHeight : paddleHeights){
+                for(pong::AiSettings const& left : profiles){
+                    for(pong::AiSettings const& right : profiles){
+                        configs.push_back(Config{pong::Rules{ballSpeed, paddleSpeed, paddleHeight}, left, right});
+                    }
+                }
+            }
+        }
+    }
+    
+    uint64_t jobCount = static_cast<uint64_t>(configs.size()) * settings.matchesPerConfig;
+    if(jobCount > UINT32_MAX){
+        std::fprintf(stderr, "Too many matches: %llu\n", static_cast<unsigned long long>(jobCount));
+        return 2;
+    }
+    uint32_t jobs = static_cast<uint32_t>(jobCount);
+    
+    WorkRanges work(jobs, threads);
+    std::vector<Worker> workers(threads);
+    for(Worker& worker : workers){
+        worker.tallies.resize(configs.size());
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(int w = 0; w < threads; ++w){
+        pool.emplace_back([&, w]{
+            Worker& worker = workers[w];
+            uint32_t job;
+            while(true){
+                if(!work.Take(w, job)){
+                    if(!work.Steal(w, job)){
+                        break;
+                    }
+                    ++worker.steals;
+                }
+                uint32_t config = job / static_cast<uint32_t>(settings.matchesPerConfig);
+                PlayMatch(configs[config], settings, job, worker.tallies[config]);
+            }
+        });
+    }
+    for(std::thread& thread : pool){
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    // Every worker is done, now their tallies can be added up
+    std::vector<Tally> totals(configs.size());
+    Tally overall;
+    uint64_t steals = 0;
+    for(Worker const& worker : workers){
+        for(std::size_t c = 0; c < configs.size(); ++c){
+            totals[c].Add(worker.tallies[c]);
+        }
+        steals += worker.steals;
+    }
+    
+    std::printf("%6s %6s %6s  %-10s %-10s %7s %7s %7s %7s %8s %8s %8s %8s\n", "ball", "paddle", "height", "left ai", "right ai",
+                "matches", "left%", "right%", "draw%", "points", "rally", "longest", "rally s");
+    for(std::size_t c = 0; c < configs.size(); ++c){
+        Config const& config = configs[c];
+        Tally const& tally = totals[c];
+        overall.Add(tally);
+        
+        char left[32];
+        char right[32];
+        std::snprintf(left, sizeof(left), "%g:%g", config.left.reactionMs, config.left.errorPx);
+        std::snprintf(right, sizeof(right), "%g:%g", config.right.reactionMs, config.right.errorPx);
+        double matches = static_cast<double>(tally.matches);
+        double rallies = tally.rallies > 0 ? static_cast<double>(tally.rallies) : 1.0;
+        std::printf("%6g %6g %6g  %-10s %-10s %7llu %7.1f %7.1f %7.1f %8.2f %8.2f %8llu %8.2f\n",
+                    config.rules.ballSpeed, config.rules.paddleSpeed, config.rules.paddleHeight, left, right,
+                    static_cast<unsigned long long>(tally.matches),
+                    100.0 * tally.leftWins / matches, 100.0 * tally.rightWins / matches, 100.0 * tally.draws / matches,
+                    tally.points / matches, tally.rallyHits / rallies, static_cast<unsigned long long>(tally.longestRally),
+                    tally.rallySteps * pong::FIXED_DT / 1000.0 / rallies);
+    }
+    
+    double gameSeconds = overall.steps * pong::FIXED_DT / 1000.0;
+    std::printf("%llu matches, %llu steps (%.1f h of play) in %.3f s on %d threads, %llu steals\n",
+                static_cast<unsigned long long>(overall.matches), static_cast<unsigned long long>(overall.steps),
+                gameSeconds / 3600.0, seconds, threads, static_cast<unsigned long long>(steals));
+    if(seconds > 0.0){
+        std::printf("%.0f matches/s, %.0f steps/s, %.0fx real time\n", overall.matches / seconds,
+                    overall.steps / seconds, gameSeconds / seconds);
+    }
+    return 0;
+}